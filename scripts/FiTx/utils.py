@@ -1,4 +1,5 @@
 import os
+import re
 from pathlib import Path
 import typing
 
@@ -31,7 +32,7 @@ def remove_redundant_log(log: str):
     return '\n'.join(splitted_logs)
 
 
-def get_files(target: Path) -> typing.List[Path]:
+def get_files(target: Path, suffix='.c') -> typing.List[Path]:
     target_files = []
 
     if target.is_file():
@@ -40,12 +41,30 @@ def get_files(target: Path) -> typing.List[Path]:
     for dirpath, _, filenames in os.walk(target):
         target_files += [
             Path(dirpath) / Path(file) for file in filenames
-            if Path(file).suffix == '.c'
+            if Path(file).suffix == suffix
         ]
 
     return target_files
 
 
+def expected_log_file(test_file: Path) -> Path:
+    # tests/<bug>/src/<name>.c is expected to log tests/<bug>/expected/<name>.log
+    return test_file.parent.parent / "expected" / (test_file.stem + ".log")
+
+
+def normalize_log(log: str) -> typing.List[str]:
+    """Keep the error and transition lines of |log|, with the directories of
+    the paths and the LLVM dependent value types dropped, so that logs of the
+    same test compare equal wherever and with whichever LLVM they ran."""
+    lines = []
+    for line in log.split('\n'):
+        if not line.strip().startswith(("[ERROR]", "[LOG]")):
+            continue
+        line = re.sub(r'/\S*/([^/\s]+:\d+:\d+:)', r'\1', line)
+        lines.append(re.sub(r'ValueType: \d+', 'ValueType: _', line))
+    return lines
+
+
 def get_log_files(target: Path) -> typing.List[Path]:
     target_files = []
 
@@ -84,3 +103,37 @@ def make_linux_build_command(target, job, compiler_flags=[], make_flags=[]):
     ]
 
     return BASE_LINUX_MAKE_COMMAND + make_flags
+
+
+def make_cfg_benchmark(blocks: int) -> str:
+    """Returns LLVM IR of a function with |blocks| basic blocks. Each block
+    loads a pointer and branches to the next block or skips over it, so the
+    CFG has about two edges per block and many join points."""
+    lines = [
+        'declare noalias i8* @malloc(i64)',
+        'declare void @free(i8*)',
+        '',
+        'define void @cfg_bench(i32 %n) {',
+        'entry:',
+        '  %p.addr = alloca i8*, align 8',
+        '  %p = call noalias i8* @malloc(i64 8)',
+        '  store i8* %p, i8** %p.addr, align 8',
+        '  br label %b0',
+    ]
+    for i in range(blocks):
+        skip = min(i + 2, blocks)
+        lines += [
+            f'b{i}:',
+            f'  %v{i} = load i8*, i8** %p.addr, align 8',
+            f'  %c{i} = icmp eq i32 %n, {i}',
+            f'  br i1 %c{i}, label %b{i + 1}, label %b{skip}',
+        ]
+    lines += [
+        f'b{blocks}:',
+        '  %last = load i8*, i8** %p.addr, align 8',
+        '  call void @free(i8* %last)',
+        '  ret void',
+        '}',
+        '',
+    ]
+    return '\n'.join(lines)
@@ -17,6 +17,11 @@ LOG_DIR       = os.path.abspath("/tmp/log")
 BUILD_DIR     = os.path.join(FITX_ROOT, 'build')
 DETECTOR_PATH = os.path.join(BUILD_DIR, 'detector', 'all_detector',
                              'libAllDetectorMod.so')
+# Tests under tests/<directory> which run with a detector of their own
+TEST_DETECTOR_PATHS = {
+    "merge": os.path.join(BUILD_DIR, 'detector', 'merge_detector',
+                          'libMergeDetectorMod.so'),
+}
 
 @click.group()
 def commands():
@@ -86,17 +91,29 @@ def linux(target, file, measure):
 
 @commands.command()
 @click.argument("target", type=click.Path(exists=True))
-def test(target):
+@click.option("--ir", is_flag=True,
+              help="Run the .ll tests with opt instead of compiling the .c ones")
+@click.option("--opt", default="opt")
+@click.option("--check", is_flag=True,
+              help="Compare each log with the expected log of the test")
+def test(target, ir, opt, check):
     print(f"Running test on {target}")
-    target_files = utils.get_files(Path(target))
-    additional_flags = ["-Xclang", "-load", "-Xclang", DETECTOR_PATH]
+    target_files = utils.get_files(Path(target), '.ll' if ir else '.c')
 
     print(f"Found {len(target_files)} tests")
+    failed = []
     for target in target_files:
         print(f"[Running] {target}\r", end="")
-        compile_command = ["clang", target, "-o", "/dev/null"
-                           ] + utils.compilation_flags(additional_flags)
-        result = subprocess.run(compile_command, stderr=subprocess.PIPE)
+        detector = TEST_DETECTOR_PATHS.get(Path(target).parent.parent.name,
+                                           DETECTOR_PATH)
+        additional_flags = ["-Xclang", "-load", "-Xclang", detector]
+        if ir:
+            command = [opt, "-enable-new-pm=0", "-O0", "-load", detector,
+                       "-disable-output", target]
+        else:
+            command = ["clang", target, "-o", "/dev/null"
+                       ] + utils.compilation_flags(additional_flags)
+        result = subprocess.run(command, stderr=subprocess.PIPE)
         logs = utils.remove_redundant_log(result.stderr.decode('utf-8'))
 
         if logs:
@@ -104,6 +121,43 @@ def test(target):
             print("")
             print(logs.strip())
 
+        expected = utils.expected_log_file(Path(target))
+        if not check or not expected.exists():
+            continue
+        with open(expected) as f:
+            if utils.normalize_log(f.read()) != utils.normalize_log(logs):
+                failed.append(target)
+                print(f"\n[FAILED] {target} does not match {expected}")
+
+    if check:
+        print(f"\n{len(failed)} tests did not match their expected log")
+        if failed:
+            raise SystemExit(1)
+
+
+@commands.command("cfg-bench")
+@click.option("--blocks", "-b", multiple=True, type=int,
+              default=[12500, 25000, 50000])
+@click.option("--opt", default="opt")
+def cfg_bench(blocks, opt):
+    """Time the framework IR generation on synthetic functions of growing size.
+    The time should grow linearly with the number of blocks."""
+    for block_num in blocks:
+        bench_file = os.path.join(LOG_DIR, f"cfg_bench_{block_num}.ll")
+        os.makedirs(LOG_DIR, exist_ok=True)
+        with open(bench_file, 'w+') as f:
+            f.write(utils.make_cfg_benchmark(block_num))
+
+        # Only the IR generation is timed, the analysis is measured with
+        # -measure
+        command = [opt, "-enable-new-pm=0", "-load", DETECTOR_PATH,
+                   "-ir_generator", "-time-passes", "-disable-output",
+                   bench_file]
+        result = subprocess.run(command, stderr=subprocess.PIPE)
+        report = result.stderr.decode('utf-8')
+        timing = [line for line in report.split('\n')
+                  if "Generate FrameworkIR" in line]
+        print(f"{block_num} blocks: {timing[0].strip() if timing else report}")
 
 if __name__ == "__main__":
     commands()
@@ -0,0 +1,73 @@
+#include "alloc.hpp"
+#include "frontend/Framework.hpp"
+#include "frontend/State.hpp"
+#include "refcount.hpp"
+
+/* State managers which merge at join points with the FLEX and CUSTOM methods,
+ * to test the merge methods apart from the shipped detectors, which all merge
+ * STRICT. tests/merge holds their tests. */
+namespace {
+// Reference counter whose paths joining with the same count keep only their
+// net transition
+class FlexMergeDetector : public framework::FrameworkPass {
+  virtual void defineStates() override {
+    framework::StateManager manager;
+    framework::State &init = manager.getInitState();
+
+    auto inc_rule = framework::FunctionArgTransitionRule(inc_funcs);
+    auto dec_rule = framework::FunctionArgTransitionRule(dec_funcs);
+
+    auto counted_args = framework::StateArgs(
+        "flex counted", framework::NORMAL, framework::MODULE_END, true,
+        framework::NONE, framework::StateMergeMethod::FLEX);
+    manager.createCounterState(init, counted_args, 10, inc_rule, dec_rule,
+                               {1});
+    addStateManager(manager);
+  }
+};
+
+// Double free detector whose values freed on several incoming paths keep the
+// shortest of their histories
+class CustomMergeDetector : public framework::FrameworkPass {
+  virtual void defineStates() override {
+    framework::StateManager manager;
+    framework::State &init = manager.getInitState();
+
+    auto free_args = framework::StateArgs(
+        "custom free", framework::StateType::NORMAL,
+        framework::BugNotificationTiming::IMMEDIATE, true, framework::NONE,
+        framework::StateMergeMethod::CUSTOM);
+    framework::State &free = manager.createState(free_args);
+
+    auto df_args =
+        framework::StateArgs("custom double free", framework::StateType::BUG);
+    framework::State &double_free = manager.createState(df_args);
+
+    auto free_func_rule = framework::FunctionArgTransitionRule(free_funcs);
+    manager.addTransition(init, free, free_func_rule);
+    manager.addTransition(free, double_free, free_func_rule);
+
+    auto store_any_rule = framework::StoreValueTransitionRule(
+        framework::StoreValueTransitionRule::ANY);
+    store_any_rule.setConsiderNullBranch(false);
+    manager.addTransition(free, init, store_any_rule);
+
+    manager.setCustomMerge(
+        [](const std::vector<const framework::TransitionLogs *> &candidates) {
+          const framework::TransitionLogs *merged = nullptr;
+          for (auto logs : candidates) {
+            if (!merged || logs->CurrentState() < merged->CurrentState() ||
+                (logs->CurrentState() == merged->CurrentState() &&
+                 logs->Size() < merged->Size()))
+              merged = logs;
+          }
+          return *merged;
+        });
+    addStateManager(manager);
+  }
+};
+
+}  // namespace
+
+std::vector<framework::FrameworkPass *> framework::FrameworkPass::passes = {
+    new FlexMergeDetector(), new CustomMergeDetector()};
@@ -11,17 +11,9 @@ void defineStates(framework::StateManager& manager) {
   auto inc_rule = framework::FunctionArgTransitionRule(inc_funcs);
   auto dec_rule = framework::FunctionArgTransitionRule(dec_funcs);
 
-  framework::State* prev = &init;
-  for (int i = 0; i < 10; i++) {
-    framework::StateType type =
-        i == 1 ? framework::StateType::BUG : framework::StateType::NORMAL;
-    auto counted_args = framework::StateArgs("counted " + std::to_string(i),
-                                             type, framework::MODULE_END);
-
-    framework::State& counted = manager.createState(counted_args);
-    manager.addTransition(*prev, counted, inc_rule);
-    manager.addTransition(counted, *prev, dec_rule);
-    prev = &counted;
-  }
+  // Reported when the count reaches "counted 1"
+  auto counted_args =
+      framework::StateArgs("counted", framework::NORMAL, framework::MODULE_END);
+  manager.createCounterState(init, counted_args, 10, inc_rule, dec_rule, {1});
 }
 }  // namespace ReferenceCounter
@@ -9,18 +9,14 @@ namespace UnreferenceCounter {
     auto inc_rule = framework::FunctionArgTransitionRule(inc_funcs);
     auto dec_rule = framework::FunctionArgTransitionRule(dec_funcs);
 
-    framework::State *prev = &init;
-    for (int i = 0; i < 10; i++) {
-      framework::StateType type =
-          i != 0 ? framework::StateType::BUG : framework::StateType::NORMAL;
-      auto counted_args = framework::StateArgs("uncounted " + std::to_string(i),
-                                               type, framework::MODULE_END);
+    // Every count below the first is a bug
+    std::set<int> bug_counts;
+    for (int i = 1; i < 10; i++) bug_counts.insert(i);
 
-      framework::State &counted = manager.createState(counted_args);
-      manager.addTransition(*prev, counted, dec_rule);
-      manager.addTransition(counted, *prev, inc_rule);
-      prev = &counted;
-    }
+    auto counted_args = framework::StateArgs("uncounted", framework::NORMAL,
+                                             framework::MODULE_END);
+    manager.createCounterState(init, counted_args, 10, dec_rule, inc_rule,
+                               bug_counts);
   }
 
 }
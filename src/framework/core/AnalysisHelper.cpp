@@ -13,6 +13,12 @@
 #include <vector>
 
 namespace framework {
+static std::vector<long> getValueIndices(llvm::GetElementPtrInst *inst);
+static long getMemberIndiceFromByte(llvm::Instruction *instruction,
+                                    llvm::StructType *STy, uint64_t byte);
+static const llvm::StructLayout *getStructLayout(llvm::Instruction *instruction,
+                                                 llvm::StructType *STy);
+
 std::vector<framework::Value::Fields> decodeGetElementPtrInst(
     llvm::GetElementPtrInst *get_element_ptr_inst) {
   llvm::Type *Ty = get_element_ptr_inst->getPointerOperandType();
@@ -101,11 +107,7 @@ bool isInPredecessor(std::shared_ptr<framework::BasicBlock> target,
                      std::shared_ptr<framework::BasicBlock> block, int depth) {
   if (depth < 0) return false;
 
-  for (auto pred_ref : block->Predecessors()) {
-    auto pred = pred_ref.lock();
-    if (!pred)
-      continue;
-
+  for (auto& pred : block->Predecessors()) {
     if (pred == target || isInPredecessor(target, pred, depth - 1))
       return true;
   }
@@ -7,7 +7,7 @@
 
 namespace framework {
 BasicBlock::BasicBlock(llvm::BasicBlock* basic_block)
-    : llvm_basic_block_(basic_block), line_(0), id_(kNoId) {
+    : id_(kNoId), llvm_basic_block_(basic_block), line_(0) {
   name_ = basic_block->getName();
   line_ = getLine(basic_block->getFirstNonPHIOrDbgOrLifetime());
   parent_ =
@@ -40,18 +40,25 @@ bool operator==(const std::shared_ptr<framework::BasicBlock> basic_block,
 }
 
 void BasicBlock::addSuccessor(std::shared_ptr<framework::BasicBlock> block) {
-  successors_.insert(block);
+  added_successors_.push_back(block.get());
 }
 
 void BasicBlock::addPredecessor(std::shared_ptr<framework::BasicBlock> block) {
-  predecessors_.insert(block);
+  added_predecessors_.push_back(block.get());
+}
+
+void BasicBlock::setAdjacency(BlockList predecessors, BlockList successors) {
+  predecessors_ = predecessors;
+  successors_ = successors;
+  added_predecessors_ = std::vector<framework::BasicBlock*>();
+  added_successors_ = std::vector<framework::BasicBlock*>();
 }
 
 bool BasicBlock::isInPredecessor(std::shared_ptr<framework::BasicBlock> block) {
-  return std::find_if(predecessors_.begin(), predecessors_.end(),
-                      [block](std::weak_ptr<framework::BasicBlock> pred) {
-                        return pred.lock() == block;
-                      }) != predecessors_.end();
+  for (auto& pred : predecessors_) {
+    if (pred == block) return true;
+  }
+  return false;
 }
 
 void BasicBlock::addInstruction(std::shared_ptr<framework::Instruction> inst) {
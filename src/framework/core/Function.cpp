@@ -6,109 +6,150 @@
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/CFG.h"
 
+// include STL
+#include <algorithm>
+#include <set>
+#include <stack>
+
 namespace framework {
 std::shared_ptr<framework::Function> Function::createManagedFunction(
     llvm::Function* function, std::unique_ptr<llvm::LoopInfo> loop_info) {
-  if (created_functions_.find(function) == created_functions_.end())
-    created_functions_[function] =
+  std::lock_guard<std::mutex> guard(created_functions_mutex_);
+  if (created_functions_.find(function) == created_functions_.end()) {
+    auto created =
         std::make_shared<framework::Function>(function, std::move(loop_info));
+    created->id_ = created_functions_.size();
+    created_functions_[function] = created;
+  }
 
   if (!created_functions_[function]->hasLoopInfo() && loop_info)
     created_functions_[function]->setLoopInfo(std::move(loop_info));
   return created_functions_[function];
 }
 
+uint32_t Function::Classify(const std::string& name) {
+  uint32_t kind = 0;
+  if (findFunctionName(name, "llvm.dbg")) kind |= kDebugFunction;
+  if (findFunctionName(name, "llvm.dbg.value")) kind |= kDebugValueFunction;
+  if (findFunctionName(name, "llvm.dbg.declare"))
+    kind |= kDebugDeclareFunction;
+  if (findFunctionName(name, "llvm.lifetime.end"))
+    kind |= kLifetimeEndFunction;
+  if (findFunctionName(name, "llvm.expect")) kind |= kExpectFunction;
+  if (findFunctionName(name, "memset")) kind |= kMemSetFunction;
+
+  if (std::find(refcount_decrement_functions.begin(),
+                refcount_decrement_functions.end(),
+                name) != refcount_decrement_functions.end())
+    kind |= kRefcountDecrementFunction;
+  if (std::find(err_functions.begin(), err_functions.end(), name) !=
+      err_functions.end())
+    kind |= kErrorFunction;
+  return kind;
+}
+
 bool Function::IsDebugValueFunction(
     std::shared_ptr<framework::Function> function) {
-  return findFunctionName(function->Name(), "llvm.dbg.value");
+  return function->isKind(kDebugValueFunction);
 }
 
 bool Function::IsDebugDeclareFunction(
     std::shared_ptr<framework::Function> function) {
-  return findFunctionName(function->Name(), "llvm.dbg.declare");
+  return function->isKind(kDebugDeclareFunction);
 }
 
 bool Function::IsLifetimeEndFunction(
     std::shared_ptr<framework::Function> function) {
-  return findFunctionName(function->Name(), "llvm.lifetime.end");
+  return function->isKind(kLifetimeEndFunction);
 }
 
 bool Function::IsExpectFunction(
     std::shared_ptr<framework::Function> function) {
-  return findFunctionName(function->Name(), "llvm.expect");
+  return function->isKind(kExpectFunction);
 }
 
 bool Function::IsRefcountDecrementFunction(
     std::shared_ptr<framework::Function> function) {
-  return std::find(refcount_decrement_functions.begin(),
-                   refcount_decrement_functions.end(),
-                   function->Name()) != refcount_decrement_functions.end();
+  return function->isKind(kRefcountDecrementFunction);
 }
 
 bool Function::IsMemSetFunction(
     std::shared_ptr<framework::Function> function) {
-  return findFunctionName(function->Name(), "memset");
+  return function->isKind(kMemSetFunction);
 }
 
 Function::Function(llvm::Function* function,
                    std::unique_ptr<llvm::LoopInfo> loop_info)
     : llvm_function_(function),
-      function_name_(function->getName()),
+      id_(0),
       return_type_(function->getReturnType()),
+      loop_info_(std::move(loop_info)),
+      function_name_(function->getName()),
+      kind_(Classify(function_name_)),
       is_definition_(function->isDeclaration()),
       arg_size_(function->arg_size()),
-      loop_info_(std::move(loop_info)),
-      contains_loop_back_blocks_(false),
       return_value_(nullptr),
+      contains_loop_back_blocks_(false),
       protected_refcount_value_(nullptr) {}
 
 std::shared_ptr<framework::BasicBlock> Function::getBasicBlock(
     llvm::BasicBlock* basic_block) {
-  auto block =
-      std::find(basic_blocks_.begin(), basic_blocks_.end(), basic_block);
-  if (block != basic_blocks_.end()) return *block;
-
-  auto framework_block = std::make_shared<framework::BasicBlock>(basic_block);
-  basic_blocks_.insert(framework_block);
-
-  framework_block->collectPassthroughBlock();
-
-  if (basic_block == &llvm_function_->getEntryBlock())
-    init_block_ = framework_block;
+  if (!basic_blocks_built_) buildBasicBlocks();
 
-  llvm::Loop* loop =
-      loop_info_.get() ? loop_info_->getLoopFor(basic_block) : nullptr;
-
-  if (auto branch_inst =
-          llvm::dyn_cast<llvm::BranchInst>(basic_block->getTerminator())) {
-    framework_block->setBranchInst(framework::BranchInst::Create(branch_inst));
-  } else if (auto switch_inst = llvm::dyn_cast<llvm::SwitchInst>(
-                 basic_block->getTerminator())) {
-    framework_block->setBranchInst(framework::BranchInst::Create(switch_inst));
-  }
-
-  // Generate Predecessor Information
-  for (auto block : llvm::successors(basic_block)) {
-    std::shared_ptr<framework::BasicBlock> successor = getBasicBlock(block);
-    framework_block->addSuccessor(successor);
+  auto index = basic_block_index_.find(basic_block);
+  if (index == basic_block_index_.end()) return nullptr;
+  return basic_blocks_[index->second];
+}
 
-    if (successor->Line() <= framework_block->Line())
-      setLoopBackBlock(true);
+void Function::buildBasicBlocks() {
+  // Creating the terminators looks up other blocks, so every block is created
+  // before any of them is connected
+  basic_blocks_built_ = true;
+  for (auto& basic_block : *llvm_function_) {
+    basic_block_index_[&basic_block] = basic_blocks_.size();
+    basic_blocks_.push_back(
+        std::make_shared<framework::BasicBlock>(&basic_block));
   }
-
-  // Generate Succesor Information
-  for (auto block : llvm::predecessors(basic_block)) {
-    // If we are see a loop header, remove any incoming blocks from the loop
-    // itself. This prevents "revisiting the loop blocks" and causing lots of
-    // FPs.
-    if (loop && loop->getHeader() == basic_block &&
-        loop->getBlocksSet().find(block) != loop->getBlocksSet().end())
-      continue;
-
-    framework_block->addPredecessor(getBasicBlock(block));
+  if (!basic_blocks_.empty()) init_block_ = basic_blocks_.front();
+
+  for (auto& framework_block : basic_blocks_) {
+    llvm::BasicBlock* basic_block = framework_block->LLVMBasicBlock();
+    framework_block->collectPassthroughBlock();
+
+    llvm::Loop* loop =
+        loop_info_.get() ? loop_info_->getLoopFor(basic_block) : nullptr;
+
+    if (auto branch_inst =
+            llvm::dyn_cast<llvm::BranchInst>(basic_block->getTerminator())) {
+      framework_block->setBranchInst(
+          framework::BranchInst::Create(branch_inst));
+    } else if (auto switch_inst = llvm::dyn_cast<llvm::SwitchInst>(
+                   basic_block->getTerminator())) {
+      framework_block->setBranchInst(
+          framework::BranchInst::Create(switch_inst));
+    }
+
+    // Generate Successor Information
+    for (auto block : llvm::successors(basic_block)) {
+      auto& successor = basic_blocks_[basic_block_index_[block]];
+      framework_block->addSuccessor(successor);
+
+      if (successor->Line() <= framework_block->Line())
+        setLoopBackBlock(true);
+    }
+
+    // Generate Predecessor Information
+    for (auto block : llvm::predecessors(basic_block)) {
+      // If we are see a loop header, remove any incoming blocks from the loop
+      // itself. This prevents "revisiting the loop blocks" and causing lots of
+      // FPs.
+      if (loop && loop->getHeader() == basic_block &&
+          loop->getBlocksSet().find(block) != loop->getBlocksSet().end())
+        continue;
+
+      framework_block->addPredecessor(basic_blocks_[basic_block_index_[block]]);
+    }
   }
-
-  return framework_block;
 }
 
 bool Function::isLoopBlock(std::shared_ptr<framework::BasicBlock> block) {
@@ -152,6 +193,158 @@ std::shared_ptr<framework::Instruction> Function::lastRefcountInstruction() {
   return last_refcount_call_;
 }
 
+void Function::buildControlFlowGraph() {
+  auto build = [this](auto added, std::vector<uint32_t>& offsets,
+                      std::vector<uint32_t>& ids) {
+    offsets.assign(1, 0);
+    for (auto block : ordered_basic_blocks_) {
+      // Neighbours are kept in the order of the LLVM blocks, without
+      // duplicates from switch cases
+      std::vector<framework::BasicBlock*> neighbours = added(block);
+      std::sort(neighbours.begin(), neighbours.end(), [](auto lhs, auto rhs) {
+        return lhs->LLVMBasicBlock() < rhs->LLVMBasicBlock();
+      });
+      neighbours.erase(std::unique(neighbours.begin(), neighbours.end()),
+                       neighbours.end());
+
+      for (auto neighbour : neighbours) {
+        if (neighbour->Id() != BasicBlock::kNoId)
+          ids.push_back(neighbour->Id());
+      }
+      offsets.push_back(ids.size());
+    }
+  };
+
+  build([](auto block) { return block->AddedPredecessors(); },
+        predecessor_offsets_, predecessor_ids_);
+  build([](auto block) { return block->AddedSuccessors(); },
+        successor_offsets_, successor_ids_);
+
+  const auto* blocks = ordered_basic_blocks_.data();
+  for (size_t i = 0; i < ordered_basic_blocks_.size(); i++) {
+    ordered_basic_blocks_[i]->setAdjacency(
+        BlockList(blocks, predecessor_ids_.data() + predecessor_offsets_[i],
+                  predecessor_ids_.data() + predecessor_offsets_[i + 1]),
+        BlockList(blocks, successor_ids_.data() + successor_offsets_[i],
+                  successor_ids_.data() + successor_offsets_[i + 1]));
+  }
+
+  buildBranchFacts();
+}
+
+void Function::buildBranchFacts() {
+  branch_facts_.assign(ordered_basic_blocks_.size(), BranchFacts());
+  for (auto& block : ordered_basic_blocks_) {
+    auto branch_inst = block->getBranchInst();
+    if (!branch_inst || !branch_inst->Condition()) continue;
+    auto compare_inst =
+        shared_dyn_cast<framework::CompareInst>(branch_inst->Condition());
+    if (!compare_inst) continue;
+
+    auto& facts = branch_facts_[block->Id()];
+    facts.predicate = compare_inst->GetPredicate();
+    for (auto operand : compare_inst->Operands()) {
+      if (auto const_value = shared_dyn_cast<framework::ConstValue>(operand)) {
+        facts.compared_value = const_value->getConstValue();
+        break;
+      }
+      if (shared_isa<framework::NullValue>(operand)) {
+        facts.is_null = true;
+        break;
+      }
+    }
+  }
+
+  predecessor_facts_.assign(predecessor_ids_.size(), EdgeFacts());
+  for (auto& block : ordered_basic_blocks_) {
+    auto* facts = predecessor_facts_.data() + predecessor_offsets_[block->Id()];
+    for (auto& pred : block->Predecessors()) {
+      auto& edge = *facts++;
+      auto branch_inst = pred->getBranchInst();
+      if (!branch_inst || !branch_inst->Condition()) continue;
+      auto compare_inst =
+          shared_dyn_cast<framework::CompareInst>(branch_inst->Condition());
+      if (!compare_inst) continue;
+
+      // Only a comparison of a single value with NULL is a null check
+      bool null_exists = false;
+      std::shared_ptr<framework::Value> compared = nullptr;
+      for (auto operand : compare_inst->Operands()) {
+        if (shared_isa<framework::NullValue>(operand)) {
+          null_exists = true;
+          continue;
+        }
+        if (shared_isa<framework::ConstValue>(operand)) continue;
+        compared = operand;
+      }
+      if (!null_exists || !compared) continue;
+
+      auto null_nodes = compare_inst->GetPredicate() == llvm::CmpInst::ICMP_EQ
+                            ? branch_inst->TruePathNodes()
+                            : branch_inst->FalsePathNodes();
+      edge.null_checked = compared;
+      edge.is_null =
+          std::find_if(null_nodes.begin(), null_nodes.end(), [&](auto node) {
+            return node.lock() == block;
+          }) != null_nodes.end();
+    }
+  }
+}
+
+void Function::computeReversePostOrder() {
+  std::vector<std::shared_ptr<framework::BasicBlock>> post_order;
+  std::set<std::shared_ptr<framework::BasicBlock>> visited;
+
+  auto sorted_successors = [](std::shared_ptr<framework::BasicBlock> block) {
+    std::vector<std::shared_ptr<framework::BasicBlock>> successors;
+    for (auto& successor : block->Successors()) successors.push_back(successor);
+    std::sort(successors.begin(), successors.end(),
+              [](auto lhs, auto rhs) { return lhs->Id() < rhs->Id(); });
+    return successors;
+  };
+
+  // Iterative DFS, so that large functions do not overflow the native stack
+  auto visit = [&](std::shared_ptr<framework::BasicBlock> root) {
+    if (!root || !visited.insert(root).second) return;
+    std::stack<std::pair<std::shared_ptr<framework::BasicBlock>, size_t>> work;
+    std::stack<std::vector<std::shared_ptr<framework::BasicBlock>>> successors;
+    work.emplace(root, 0);
+    successors.push(sorted_successors(root));
+
+    while (!work.empty()) {
+      auto& [block, next] = work.top();
+      if (next < successors.top().size()) {
+        auto successor = successors.top()[next++];
+        if (visited.insert(successor).second) {
+          work.emplace(successor, 0);
+          successors.push(sorted_successors(successor));
+        }
+        continue;
+      }
+      post_order.push_back(block);
+      work.pop();
+      successors.pop();
+    }
+  };
+
+  visit(init_block_);
+  std::reverse(post_order.begin(), post_order.end());
+  reverse_post_order_blocks_ = post_order;
+
+  // Blocks which cannot be reached from the entry are kept in the IR order
+  for (auto block : ordered_basic_blocks_) {
+    if (visited.find(block) == visited.end())
+      reverse_post_order_blocks_.push_back(block);
+  }
+
+  // Number the instructions in this order, so that program order checks do
+  // not depend on the debug info
+  uint32_t order = 0;
+  for (auto& block : reverse_post_order_blocks_) {
+    for (auto& inst : block->Instructions()) inst->setOrder(order++);
+  }
+}
+
 void Function::setLoopBackBlock(bool loop_back) {
   contains_loop_back_blocks_ = loop_back;
 }
@@ -162,4 +355,5 @@ bool Function::ContainsLoopBackBlock() {
 
 std::map<llvm::Function*, std::shared_ptr<framework::Function>>
     framework::Function::created_functions_;
+std::mutex framework::Function::created_functions_mutex_;
 }  // namespace framework
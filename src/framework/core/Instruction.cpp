@@ -21,30 +21,26 @@ std::shared_ptr<Instruction> Instruction::Create(
 }
 
 Instruction::Instruction()
-    : llvm_instruction_(nullptr),
+    : Value(),
+      llvm_instruction_(nullptr),
       module_(nullptr),
       opcode_(0),
-      line_(0),
-      Value() {}
+      line_(0) {}
 
 Instruction::Instruction(llvm::Instruction* instruction)
-    : llvm_instruction_(instruction), Value(instruction) {
+    : Value(instruction), llvm_instruction_(instruction) {
   module_ = llvm_instruction_->getFunction()->getParent();
   opcode_ = llvm_instruction_->getOpcode();
   if (const llvm::DebugLoc& Loc = llvm_instruction_->getDebugLoc()) {
-    debug_loc_ = Loc;
     line_ = Loc.getLine();
-    column_ = Loc.getCol();
   }
 }
 
 Instruction::Instruction(unsigned int opcode, llvm::Instruction* instruction)
-    : opcode_(opcode), llvm_instruction_(instruction), Value(instruction) {
+    : Value(instruction), llvm_instruction_(instruction), opcode_(opcode) {
   module_ = llvm_instruction_->getFunction()->getParent();
   if (const llvm::DebugLoc& Loc = llvm_instruction_->getDebugLoc()) {
-    debug_loc_ = Loc;
     line_ = Loc.getLine();
-    column_ = Loc.getCol();
   }
 }
 
@@ -60,9 +56,7 @@ Instruction::Instruction(llvm::Instruction* instruction,
                 ->getBasicBlock(block);
 
   if (const llvm::DebugLoc& Loc = llvm_instruction_->getDebugLoc()) {
-    debug_loc_ = Loc;
     line_ = Loc.getLine();
-    column_ = Loc.getCol();
   }
 }
 
@@ -72,17 +66,20 @@ Instruction::Instruction(std::shared_ptr<Instruction> instruction,
       llvm_instruction_(instruction->LLVMInstruction()) {
   module_ = const_cast<llvm::Module*>(instruction->Module());
   opcode_ = instruction->Opcode();
-  debug_loc_ = instruction->getDebugLoc();
-
   line_ = instruction->Line();
-  column_ = instruction->Column();
+  order_ = instruction->Order();
   parent_ = instruction->Parent();
 }
 
 bool Instruction::operator<=(const framework::Instruction& instruction) const {
   if (llvm_instruction_ == instruction.llvm_instruction_) return true;
 
-  return module_ == instruction.module_ && line_ == instruction.line_ ||
+  if (order_ != kNoOrder && instruction.order_ != kNoOrder &&
+      llvm_instruction_->getFunction() ==
+          instruction.llvm_instruction_->getFunction())
+    return order_ <= instruction.order_;
+
+  return (module_ == instruction.module_ && line_ == instruction.line_) ||
          *this < instruction;
 }
 
@@ -136,6 +133,12 @@ llvm::raw_ostream& operator<<(llvm::raw_ostream& ostream,
 
 bool Instruction::emptyInstruction() { return !llvm_instruction_; }
 
+const llvm::DebugLoc& Instruction::getDebugLoc() {
+  static const llvm::DebugLoc empty_loc;
+  if (!llvm_instruction_) return empty_loc;
+  return llvm_instruction_->getDebugLoc();
+}
+
 bool Instruction::isInSameLine(framework::Instruction inst) {
   return line_ == inst.Line();
 }
@@ -22,10 +22,8 @@ std::shared_ptr<CompareInst> CompareInst::Create(
           [icmp_inst](std::shared_ptr<CompareInst> created) {
             std::vector<std::shared_ptr<framework::Value>> operands;
             for (auto& operand : icmp_inst->operands()) {
-              auto created_operand =
-                  framework::Value::CreateFromDefinition(operand);
-              created_operand->addUser(created);
-              operands.push_back(created_operand);
+              operands.push_back(
+                  framework::Value::CreateFromDefinition(operand));
             }
             created->setOperands(operands);
             return created;
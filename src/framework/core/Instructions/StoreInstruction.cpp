@@ -16,12 +16,10 @@ std::shared_ptr<StoreInst> StoreInst::Create(llvm::StoreInst* store_inst,
           [store_inst](std::shared_ptr<StoreInst> created) {
             auto value_operand =
                 Value::CreateFromDefinition(store_inst->getValueOperand());
-            value_operand->addUser(created);
             created->setValue(value_operand);
 
             auto pointer_operand =
                 Value::CreateFromDefinition(store_inst->getPointerOperand());
-            pointer_operand->addUser(created);
             created->setPointer(pointer_operand);
 
             return created;
@@ -44,8 +44,8 @@ void WriteEndPoint::write_log(const std::string& log) {
   return;
 }
 
-LoggingClient::LoggingClient() {
-  end_points_ = EndPoint::createEndPointPair();
+LoggingClient::LoggingClient(bool with_end_points) {
+  if (with_end_points) end_points_ = EndPoint::createEndPointPair();
   buffer_.reserve(ReadEndPoint::kBufferSize * 10);
 }
 
@@ -62,6 +62,17 @@ void LoggingClient::flush() {
   buffer_.clear();
 }
 
+void LoggingClient::truncate(size_t size) {
+  if (size < buffer_.size()) buffer_.resize(size);
+}
+
+std::string LoggingClient::extract(size_t size) {
+  if (size >= buffer_.size()) return std::string();
+  std::string logs = buffer_.substr(size);
+  buffer_.resize(size);
+  return logs;
+}
+
 void LoggingClient::printLog() {
   if (end_points_.read.valid()) llvm::errs() << end_points_.read.readLog();
 }
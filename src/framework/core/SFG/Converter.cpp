@@ -2,6 +2,7 @@
 
 #include "core/AnalysisHelper.hpp"
 #include "core/Casting.hpp"
+#include "core/Hashing.hpp"
 #include "core/Instruction.hpp"
 #include "core/Instructions.hpp"
 #include "core/Utils.hpp"
@@ -22,6 +23,7 @@ struct Converter::ValueSignature Converter::GetSignitureFromDefinition(
     llvm::Value* value) {
   bool finish_update = false;
 
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
   ValueSignature signature{value, framework::Value::kNonArrayElement,
                            std::vector<framework::Value::Fields>()};
   llvm::LoadInst* found_load_inst = nullptr;
@@ -134,13 +136,10 @@ struct Converter::ValueSignature Converter::GetSignitureFromDefinition(
         signature.fields =
             UpdateFields(std::vector<Value::Fields>({Value::Fields(
                 llvm::cast<llvm::AllocaInst>(inst)->getAllocatedType())}));
-        for (llvm::User* U : inst->users()) {
-          if (auto store = llvm::dyn_cast<llvm::StoreInst>(U)) {
-            if (llvm::isa<llvm::Argument>(store->getValueOperand())) {
-              signature.value = store->getValueOperand();
-            }
-          }
-        }
+        if (auto argument =
+                storedArgument(llvm::cast<llvm::AllocaInst>(inst)))
+          signature.value = argument;
+        [[fallthrough]];
       }
       case llvm::Instruction::Call:
         /* break; */
@@ -169,7 +168,32 @@ struct Converter::ValueSignature Converter::GetSignitureFromDefinition(
   return signature;
 }
 
+void Converter::beginModule(const llvm::Module* module) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  if (module == module_) return;
+
+  module_ = module;
+  managed_values_.clear();
+  stored_arguments_.clear();
+}
+
+llvm::Value* Converter::storedArgument(llvm::AllocaInst* alloca_inst) {
+  auto stored = stored_arguments_.find(alloca_inst);
+  if (stored != stored_arguments_.end()) return stored->second;
+
+  llvm::Value* argument = nullptr;
+  for (llvm::User* U : alloca_inst->users()) {
+    if (auto store = llvm::dyn_cast<llvm::StoreInst>(U)) {
+      if (llvm::isa<llvm::Argument>(store->getValueOperand()))
+        argument = store->getValueOperand();
+    }
+  }
+  stored_arguments_.emplace(alloca_inst, argument);
+  return argument;
+}
+
 std::shared_ptr<framework::Value> Converter::Convert(llvm::Value* llvm_value) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
   auto signature = GetSignitureFromDefinition(llvm_value);
   if (llvm::isa<llvm::Instruction>(signature.value))
     return ConvertInstruction(signature);
@@ -192,7 +216,7 @@ std::shared_ptr<framework::Instruction> Converter::ConvertInstruction(
 
   auto value = std::make_shared<framework::Instruction>(
       llvm_instruction, signature.fields, signature.array_element_num);
-  manageValue(signature.value, value);
+  manageValue(value);
   return value;
 }
 
@@ -221,14 +245,22 @@ std::shared_ptr<framework::Value> Converter::ConvertValue(
           signature.value, signature.fields, signature.array_element_num);
   }
 
-  manageValue(signature.value, value);
+  manageValue(value);
   return value;
 }
 
-void Converter::manageValue(llvm::Value* value,
-                            std::shared_ptr<framework::Value> framework_value) {
+void Converter::manageValue(
+    std::shared_ptr<framework::Value> framework_value) {
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
   ManagedValues::GetInstance().addValue(framework_value);
-  managed_values_[value].push_back(framework_value);
+
+  // Keyed by the signature of the created value. The first value managed for
+  // a signature is kept.
+  managed_values_.emplace(
+      ValueKey{&framework_value->getLLVMValue_(),
+               framework_value->ArrayElementNum(),
+               &framework_value->GetFields()},
+      framework_value);
 }
 
 std::shared_ptr<framework::Value> Converter::getManagedValue(
@@ -239,20 +271,26 @@ std::shared_ptr<framework::Value> Converter::getManagedValue(
 
 std::shared_ptr<framework::Value> Converter::getManagedValue(
     ValueSignature signature) {
-  auto managed = managed_values_.find(signature.value);
-  if (managed != managed_values_.end()) {
-    auto& values = managed->second;
-    auto found_value = std::find_if(
-        values.begin(), values.end(),
-        [&signature](std::shared_ptr<framework::Value> value) {
-          return &value->getLLVMValue_() == signature.value &&
-                 value->ArrayElementNum() == signature.array_element_num &&
-                 value->GetFields() == signature.fields;
-        });
-    if (found_value != values.end()) return *found_value;
-  }
+  std::lock_guard<std::recursive_mutex> guard(mutex_);
+  lookups_++;
+
+  // No value was managed with these fields if they were never interned
+  auto fields = Value::FindFields(signature.fields);
+  if (!fields) return std::shared_ptr<framework::Value>();
+
+  auto managed = managed_values_.find(
+      ValueKey{signature.value, signature.array_element_num, fields});
+  if (managed == managed_values_.end())
+    return std::shared_ptr<framework::Value>();
+
+  hits_++;
+  return managed->second;
+}
 
-  return std::shared_ptr<framework::Value>();
+size_t Converter::ValueKeyHash::operator()(const ValueKey& key) const {
+  uint64_t hash = HashMix(reinterpret_cast<uintptr_t>(key.value));
+  hash = HashCombine(hash, key.array_element_num);
+  return HashCombine(hash, reinterpret_cast<uintptr_t>(key.fields));
 }
 
 }  // namespace framework
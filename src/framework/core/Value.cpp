@@ -21,6 +21,7 @@
 #include "llvm/Pass.h"
 #include "llvm/PassAnalysisSupport.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 
@@ -30,43 +31,105 @@
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <mutex>
 #include <queue>
 #include <set>
+#include <shared_mutex>
 #include <stack>
 #include <string>
 #include <vector>
 
 #include "core/AnalysisHelper.hpp"
 #include "core/Casting.hpp"
+#include "core/Hashing.hpp"
 #include "core/Instructions.hpp"
 #include "core/SFG/Converter.hpp"
 #include "core/Utils.hpp"
 #include "core/Value.hpp"
 
 namespace framework {
+size_t Value::FieldListHash::operator()(const FieldList& fields) const {
+  uint64_t hash = fields.size();
+  for (auto& field : fields) {
+    hash = HashCombine(hash, reinterpret_cast<uintptr_t>(field.type));
+    hash = HashCombine(hash, field.field);
+  }
+  return hash;
+}
+
+namespace {
+// Interned lists are never freed, so that values can point to them. The lists
+// are sharded by hash, and each shard is read under a shared lock, so that
+// analyzer threads looking up lists already interned do not wait on each
+// other. Only the first interning of a list takes a shard exclusively.
+struct FieldListShard {
+  std::shared_mutex mutex;
+  std::unordered_set<Value::FieldList, Value::FieldListHash> lists;
+};
+
+constexpr size_t kFieldListShards = 16;
+
+FieldListShard& FieldListShardOf(const Value::FieldList& fields) {
+  size_t hash = Value::FieldListHash()(fields);
+  static auto* shards = new FieldListShard[kFieldListShards];
+  return shards[hash % kFieldListShards];
+}
+}  // namespace
+
+const Value::FieldList* Value::InternFields(const FieldList& fields) {
+  auto& shard = FieldListShardOf(fields);
+  {
+    std::shared_lock<std::shared_mutex> guard(shard.mutex);
+    auto interned = shard.lists.find(fields);
+    if (interned != shard.lists.end()) return &*interned;
+  }
+  std::unique_lock<std::shared_mutex> guard(shard.mutex);
+  return &*shard.lists.insert(fields).first;
+}
+
+const Value::FieldList* Value::FindFields(const FieldList& fields) {
+  auto& shard = FieldListShardOf(fields);
+  std::shared_lock<std::shared_mutex> guard(shard.mutex);
+  auto interned = shard.lists.find(fields);
+  if (interned == shard.lists.end()) return nullptr;
+  return &*interned;
+}
+
 Value::Value(llvm::Value* value, std::vector<Fields> fields,
              long array_element_num)
     : value_(value),
-      fields_(fields),
+      fields_(InternFields(fields)),
       array_element_num_(array_element_num),
+      value_type_(value->getValueID()),
       is_global_var_(llvm::isa<llvm::GlobalValue>(value)),
-      value_type_(value->getValueID()) {}
+      is_return_value_(false) {}
 
 Value::Value(std::shared_ptr<framework::Value> value,
              std::vector<Fields> fields, long array_element_num)
     : value_(value->value_),
-      fields_(fields),
+      fields_(InternFields(fields)),
       array_element_num_(array_element_num),
+      value_type_(value->getValueID()),
       is_global_var_(value->isGlobalVar()),
-      is_return_value_(value->is_return_value_),
-      value_type_(value->getValueID()) {}
+      is_return_value_(value->is_return_value_) {}
 
 Value::Value(const Value& value)
     : value_(value.value_),
       fields_(value.fields_),
       array_element_num_(value.array_element_num_),
+      value_type_(value.getValueID()),
       is_global_var_(value.is_global_var_),
-      value_type_(value.getValueID()) {}
+      is_return_value_(value.is_return_value_) {}
+
+Value& Value::operator=(const Value& value) {
+  value_ = value.value_;
+  fields_ = value.fields_;
+  array_element_num_ = value.array_element_num_;
+  is_global_var_ = value.is_global_var_;
+  is_return_value_ = value.is_return_value_;
+  value_type_ = value.value_type_;
+  return *this;
+}
 
 Value::Value(std::shared_ptr<Value> value) {
   value_ = value->value_;
@@ -83,6 +146,9 @@ std::shared_ptr<Value> Value::CreateFromDefinition(llvm::Value* value) {
 
 std::shared_ptr<Value> Value ::CreateAppend(std::shared_ptr<Value> src,
                                             std::shared_ptr<Value> target) {
+  // Lookup and creation of the appended value has to be atomic
+  std::lock_guard<std::recursive_mutex> guard(
+      Converter::GetInstance().Mutex());
   auto source_back = src->GetFields().end() - 1;
   auto target_front = target->GetFields().begin();
 
@@ -145,7 +211,7 @@ std::shared_ptr<Value> Value ::CreateAppend(std::shared_ptr<Value> src,
                                                  array_element_num);
   }
 
-  Converter::GetInstance().manageValue(&src->getLLVMValue_(), value);
+  Converter::GetInstance().manageValue(value);
   return value;
 }
 
@@ -155,34 +221,28 @@ bool Value::operator<(const Value& V) const {
   if (array_element_num_ != V.array_element_num_)
     return array_element_num_ < V.array_element_num_;
 
-  if (fields_.size() != V.fields_.size())
-    return fields_.size() < V.fields_.size();
+  if (fields_->size() != V.fields_->size())
+    return fields_->size() < V.fields_->size();
 
   if (value_type_ != V.value_type_) return value_type_ < V.value_type_;
 
-  for (int i = 0; i < fields_.size(); i++) {
-    if (fields_[i].type != V.fields_[i].type)
-      return fields_[i].type < V.fields_[i].type;
+  if (fields_ == V.fields_) return false;
+  for (size_t i = 0; i < fields_->size(); i++) {
+    if ((*fields_)[i].type != (*V.fields_)[i].type)
+      return (*fields_)[i].type < (*V.fields_)[i].type;
 
-    if (fields_[i].field != V.fields_[i].field)
-      return fields_[i].field < V.fields_[i].field;
+    if ((*fields_)[i].field != (*V.fields_)[i].field)
+      return (*fields_)[i].field < (*V.fields_)[i].field;
   }
 
   return false;
 }
 
 bool Value::operator==(const Value& V) const {
-  if (value_ != V.value_ || fields_.size() != V.fields_.size() ||
-      array_element_num_ != V.array_element_num_ ||
-      value_type_ != V.value_type_)
-    return false;
-
-  for (int i = 0; i < fields_.size(); i++) {
-    if (fields_[i].type != V.fields_[i].type ||
-        fields_[i].field != V.fields_[i].field)
-      return false;
-  }
-  return true;
+  // Interned field lists are equal only when they are the same list
+  return value_ == V.value_ && fields_ == V.fields_ &&
+         array_element_num_ == V.array_element_num_ &&
+         value_type_ == V.value_type_;
 }
 
 bool Value::operator==(const llvm::Value* V) const { return value_ == V; }
@@ -190,15 +250,17 @@ bool Value::operator==(const llvm::Value* V) const { return value_ == V; }
 llvm::Value& Value::getLLVMValue_() const { return *value_; }
 
 llvm::Type& Value::getLLVMType_() const {
-  const Fields& field = fields_.back();
+  const Fields& field = fields_->back();
   if (field.field >= 0 && field.type->isStructTy())
     return *field.type->getStructElementType(field.field);
   return *field.type;
 }
 
-long Value::Field() const { return fields_.back().field; }
+long Value::Field() const { return fields_->back().field; }
 
-const std::vector<Value::Fields>& Value::GetFields() const { return fields_; };
+const std::vector<Value::Fields>& Value::GetFields() const {
+  return *fields_;
+};
 
 bool Value::isArgument() { return llvm::isa<llvm::Argument>(value_); }
 
@@ -211,11 +273,17 @@ void Value::setReturnValue(bool is_return_value) {
 
 long Value::ArrayElementNum() { return array_element_num_; }
 
+uint32_t ValueID::operator()(const std::shared_ptr<Value>& value) const {
+  uint32_t id = value->ManagedId();
+  if (id != Value::kUnmanagedId) return id;
+  return ManagedValues::GetInstance().addValue(value);
+}
+
 ConstValue::ConstValue(llvm::ConstantInt* value)
     : Value(value), const_value_(value->getSExtValue()) {}
 
 ConstValue::ConstValue(int64_t const_value)
-    : const_value_(const_value), Value(llvm::Value::ConstantIntVal) {}
+    : Value(llvm::Value::ConstantIntVal), const_value_(const_value) {}
 
 ConstValue::ConstValue(std::shared_ptr<ConstValue> value)
     : Value(value), const_value_(value->getConstValue()) {}
@@ -267,21 +335,63 @@ ValueCollection ValueCollection::createFromUnion(
   return result;
 }
 
+ValueCollection& ValueCollection::operator=(
+    const ValueCollection& collection) {
+  values_ = collection.values_;
+  index_.reset();
+  return *this;
+}
+
 bool ValueCollection::add(std::shared_ptr<Value> value) {
-  return values_.insert(value).second;
+  if (!values_.insert(value).second) return false;
+  if (index_) addToIndex(*index_, value);
+  return true;
 }
 
 void ValueCollection::add(const ValueCollection& value_collection) {
   auto& values = value_collection.Values();
+  if (index_) {
+    for (auto& value : values) add(value);
+    return;
+  }
   std::merge(values_.begin(), values_.end(), values.begin(), values.end(),
              std::inserter(values_, values_.end()));
 }
 
 void ValueCollection::remove(std::shared_ptr<Value> value) {
-  values_.erase(value);
+  if (values_.erase(value) && index_) removeFromIndex(*index_, value);
 }
 
-void ValueCollection::clear() { values_.clear(); }
+void ValueCollection::clear() {
+  values_.clear();
+  index_.reset();
+}
+
+const ValueCollection::Index& ValueCollection::getIndex() const {
+  if (!index_) {
+    index_ = std::make_unique<Index>();
+    for (auto& value : values_) addToIndex(*index_, value);
+  }
+  return *index_;
+}
+
+void ValueCollection::addToIndex(Index& index, std::shared_ptr<Value> value) {
+  auto& root = index[&value->getLLVMValue_()];
+  auto& fields = value->GetFields();
+  root.values_by_depth[fields.size()].insert(value);
+  for (size_t depth = 0; depth < fields.size(); depth++)
+    root.values_by_field[{depth, fields[depth].field}].insert(value);
+}
+
+void ValueCollection::removeFromIndex(Index& index,
+                                      std::shared_ptr<Value> value) {
+  auto root = index.find(&value->getLLVMValue_());
+  if (root == index.end()) return;
+  auto& fields = value->GetFields();
+  root->second.values_by_depth[fields.size()].erase(value);
+  for (size_t depth = 0; depth < fields.size(); depth++)
+    root->second.values_by_field[{depth, fields[depth].field}].erase(value);
+}
 
 bool ValueCollection::exists(framework::Value value) {
   auto found_value =
@@ -312,41 +422,42 @@ bool ValueCollection::exists(std::shared_ptr<Value> value) {
   return values_.find(value) != values_.end();
 }
 
+// Values of the same root with at least as many fields, whose field at the
+// depth of |value| matches the last field of |value|
 std::set<std::shared_ptr<Value>> ValueCollection::getRelatedValues(
     std::shared_ptr<Value> value) const {
   std::set<std::shared_ptr<Value>> related_values;
-  std::copy_if(
-      values_.begin(), values_.end(),
-      inserter(related_values, related_values.end()),
-      [&value](std::shared_ptr<framework::Value> new_value) {
-        /* auto value_fields = value->GetFields(); */
-        /* const std::vector<framework::Value::Fields> sub_value_fields( */
-        /*     value_fields.begin(), */
-        /*     value_fields.begin() + */
-        /*         std::min(value_fields.size(),
-         * new_value->GetFields().size())); */
-
-        return *new_value == &value->getLLVMValue_() &&
-               new_value->GetFields().size() >= value->GetFields().size() &&
-               (value->GetFields().empty() ||
-                value->GetFields().back().field == Value::kNonFieldVariable ||
-                value->GetFields().back().field ==
-                    new_value->GetFields()[value->GetFields().size() - 1]
-                        .field);
-      });
+  auto& index = getIndex();
+  auto root = index.find(&value->getLLVMValue_());
+  if (root == index.end()) return related_values;
+
+  auto& fields = value->GetFields();
+  if (!fields.empty() && fields.back().field != Value::kNonFieldVariable) {
+    auto& by_field = root->second.values_by_field;
+    auto values = by_field.find({fields.size() - 1, fields.back().field});
+    if (values != by_field.end()) related_values = values->second;
+    return related_values;
+  }
+
+  auto& by_depth = root->second.values_by_depth;
+  for (auto values = by_depth.lower_bound(fields.size());
+       values != by_depth.end(); values++)
+    related_values.insert(values->second.begin(), values->second.end());
   return related_values;
 }
 
+// Values of the same root with at most as many fields as |value|
 std::set<std::shared_ptr<Value>> ValueCollection::getParentValues(
     std::shared_ptr<Value> value) const {
   std::set<std::shared_ptr<Value>> related_values;
-  std::copy_if(values_.begin(), values_.end(),
-               inserter(related_values, related_values.end()),
-               [&value](std::shared_ptr<framework::Value> new_value) {
-                 return *new_value == &value->getLLVMValue_() &&
-                        new_value->GetFields().size() <=
-                            value->GetFields().size();
-               });
+  auto& index = getIndex();
+  auto root = index.find(&value->getLLVMValue_());
+  if (root == index.end()) return related_values;
+
+  auto& by_depth = root->second.values_by_depth;
+  for (auto values = by_depth.begin();
+       values != by_depth.upper_bound(value->GetFields().size()); values++)
+    related_values.insert(values->second.begin(), values->second.end());
   return related_values;
 }
 
@@ -354,12 +465,12 @@ AliasValues::AliasValues() : alias_size_(0) {}
 
 void AliasValues::addAlias(std::shared_ptr<framework::Value> src,
                            std::shared_ptr<framework::Value> target) {
-  if (alias_info_[src].add(target)) {
+  if (alias_info_[ValueID()(src)].add(target)) {
     updated_values_.push_back(src);
     alias_size_++;
   }
 
-  if (alias_info_[target].add(src)) {
+  if (alias_info_[ValueID()(target)].add(src)) {
     updated_values_.push_back(target);
     alias_size_++;
   }
@@ -374,34 +485,58 @@ void AliasValues::addAlias(AliasValues& collection) {
   if (!updated.empty()) {
     for (auto value : updated) {
       // We know that getAliasInfo will return a valid pointer since it is added
-      alias_info_[value].add(*collection.getAliasInfo(value));
-      alias_size_ += alias_info_[value].size();
+      auto& alias_info = alias_info_[ValueID()(value)];
+      alias_info.add(*collection.getAliasInfo(value));
+      alias_size_ += alias_info.size();
     }
     return;
   }
 
-  for (auto alias_info : collection.AliasInfo()) {
-    alias_info_[alias_info.first].add(alias_info.second);
-    alias_size_ += alias_info_[alias_info.first].size();
+  for (auto& alias_info : collection.AliasInfo()) {
+    auto& values = alias_info_[alias_info.first];
+    values.add(alias_info.second);
+    alias_size_ += values.size();
   }
 }
 
 const ValueCollection* AliasValues::getAliasInfo(
     std::shared_ptr<framework::Value> value) {
-  if (alias_info_.find(value) != alias_info_.end()) return &alias_info_[value];
+  auto alias_info = alias_info_.find(ValueID::Find(value));
+  if (alias_info != alias_info_.end()) return &alias_info->second;
   return nullptr;
 }
 
-ManagedValues ManagedValues::GetInstance() {
+ManagedValues& ManagedValues::GetInstance() {
   static ManagedValues* managed_values = new ManagedValues();
   return *managed_values;
 }
 
-ManagedValues::ManagedValues() { managed_values_.reserve(kReserveSize); }
+ManagedValues::ManagedValues()
+    : size_(0), chunks_(std::make_unique<Chunk[]>(kMaxChunks)) {}
+
+uint32_t ManagedValues::addValue(std::shared_ptr<framework::Value> value) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (value->ManagedId() != Value::kUnmanagedId) return value->ManagedId();
+
+  // The last ID is kept for values which are not managed
+  size_t id = size_.load(std::memory_order_relaxed);
+  if (id >= Value::kUnmanagedId || (id >> kChunkBits) >= kMaxChunks)
+    llvm::report_fatal_error("Too many managed values");
+
+  auto& chunk = chunks_[id >> kChunkBits];
+  if (!chunk)
+    chunk = std::make_unique<std::shared_ptr<framework::Value>[]>(kChunkSize);
+  chunk[id & (kChunkSize - 1)] = value;
+  value->setManagedId(id);
+
+  // Publish the value to the readers
+  size_.store(id + 1, std::memory_order_release);
+  return id;
+}
 
 std::shared_ptr<framework::Value> ManagedValues::getValueFromID(size_t id) {
-  if (id > Size()) return nullptr;
-  return managed_values_[id];
+  if (id >= Size()) return nullptr;
+  return chunks_[id >> kChunkBits][id & (kChunkSize - 1)];
 }
 
 llvm::raw_ostream& operator<<(llvm::raw_ostream& ostream,
@@ -410,7 +545,7 @@ llvm::raw_ostream& operator<<(llvm::raw_ostream& ostream,
   ostream << "ValueType: " << value.value_type_ << " ";
   ostream << "Array Element: " << value.array_element_num_ << " ";
   ostream << "(";
-  for (auto field : value.fields_) {
+  for (auto field : *value.fields_) {
     ostream << "{Type: ";
     if (field.type->isStructTy())
       ostream << field.type->getStructName();
@@ -51,6 +51,8 @@ void Analyzer::analyze(llvm::Function& function, llvm::LoopInfo& loop_info) {
     }
   }
   framework_function_->addOrderedBlock(block);
+  framework_function_->buildControlFlowGraph();
+  framework_function_->computeReversePostOrder();
 }
 
 void Analyzer::analyzeCallInst(llvm::Instruction* instruction) {
@@ -87,7 +89,7 @@ void Analyzer::analyzeCallInst(llvm::Instruction* instruction) {
   framework_block->addInstruction(framework_call);
 }
 
-void Analyzer::analyzeDebugCallInst(llvm::CallInst* call_inst) {}
+void Analyzer::analyzeDebugCallInst(llvm::CallInst* /* call_inst */) {}
 
 void Analyzer::analyzeStoreInst(llvm::Instruction* inst) {
   auto store_inst = llvm::cast<llvm::StoreInst>(inst);
@@ -202,7 +204,7 @@ bool Analyzer::collectPossibleReturnValues(
     /*       collectPossibleReturnValues(usr, visited_inst) || add_return_value;
      */
     /* } */
-  } else if (auto PHI = llvm::dyn_cast<llvm::PHINode>(V)) {
+  } else if (llvm::isa<llvm::PHINode>(V)) {
     /* for (unsigned i = 0; i < PHI->getNumIncomingValues(); i++) { */
     /* if (V != PHI->getIncomingValue(i)) */
     /*   checkErrorCodeAndAddBlock(PHI, PHI->getIncomingBlock(i), */
@@ -222,7 +224,6 @@ bool Analyzer::collectPossibleReturnValues(
     }
   } else if (auto AI = llvm::dyn_cast<llvm::AllocaInst>(V)) {
     for (auto usr : AI->users()) {
-      llvm::Value* val = usr;
       add_return_value = collectPossibleReturnValues(usr, visited_inst);
     }
     /* auto current_block = framework_function_->getBasicBlock(AI->getParent());
@@ -1,7 +1,9 @@
 #include "framework_ir/IRGenerator.hpp"
 
+#include "core/SFG/Converter.hpp"
 #include "core/Utils.hpp"
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Dominators.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/Pass.h"
@@ -12,12 +14,26 @@ IRGenerator::IRGenerator() : FunctionPass(ID) {}
 
 void IRGenerator::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
   AU.setPreservesAll();
-  AU.addRequired<llvm::LoopInfoWrapperPass>();
+}
+
+bool IRGenerator::doInitialization(llvm::Module &M) {
+  framework::Converter::GetInstance().beginModule(&M);
+  skip_module_ = module_filter_ && !module_filter_(M);
+  return false;
 }
 
 /*** Main Modular ***/
 bool IRGenerator::runOnFunction(llvm::Function &F) {
-  auto &loop_info = getAnalysis<llvm::LoopInfoWrapperPass>().getLoopInfo();
+  if (skip_module_) return false;
+  if (function_filter_ && !function_filter_(F)) {
+    skipped_functions_++;
+    return false;
+  }
+  converted_functions_++;
+
+  // The loops are only computed for the modules which are converted
+  llvm::DominatorTree dominator_tree(F);
+  llvm::LoopInfo loop_info(dominator_tree);
 
   analyzer.analyze(F, loop_info);
   framework_ir_[F.getParent()].insert(analyzer.FrameworkFunction());
@@ -31,6 +47,13 @@ std::map<llvm::Module *, std::set<std::shared_ptr<framework::Function>>>
         std::map<llvm::Module *,
                  std::set<std::shared_ptr<framework::Function>>>();
 
+bool (*ir_generator::IRGenerator::module_filter_)(llvm::Module &) = nullptr;
+bool (*ir_generator::IRGenerator::function_filter_)(llvm::Function &) =
+    nullptr;
+
+size_t ir_generator::IRGenerator::converted_functions_ = 0;
+size_t ir_generator::IRGenerator::skipped_functions_ = 0;
+
 char ir_generator::IRGenerator::ID = 1;
 
 static llvm::RegisterPass<ir_generator::IRGenerator> X(
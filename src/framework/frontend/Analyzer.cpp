@@ -33,6 +33,7 @@
 #include <llvm/Support/raw_ostream.h>
 
 #include <algorithm>
+#include <cassert>
 #include <ctime>
 #include <iostream>
 #include <iterator>
@@ -51,73 +52,70 @@
 #include "frontend/Analyzer.hpp"
 #include "frontend/CommandlineArgs.hpp"
 #include "frontend/Function.hpp"
+#include "frontend/FusedAnalyzer.hpp"
 #include "frontend/PropagationConstraint.hpp"
 
 namespace framework {
 Analyzer::Analyzer(llvm::Module &llvm_module,
                    framework::StateManager &state_manager,
                    framework::LoggingClient &client)
-    : llvm_module_(llvm_module), state_manager_(state_manager), log_(client) {}
+    : llvm_module_(llvm_module),
+      state_manager_(state_manager),
+      log_(client),
+      shared_(std::make_shared<SharedInformation>()) {}
 
 void Analyzer::analyze() {
-  auto &framework_ir = ir_generator::IRGenerator::framework_ir_;
-  if (framework_ir.find(&llvm_module_) == framework_ir.end()) return;
-  for (auto function : framework_ir[&llvm_module_]) {
-    analyzeFunction(function);
-  }
-  log_.flush();
+  FusedAnalyzer(llvm_module_, {this}).analyze();
+}
+
+std::unique_ptr<Analyzer> Analyzer::createWorker(
+    framework::LoggingClient& client) {
+  // Fill the lazily computed members, which the workers only read. The
+  // function information covers every function created so far, so that the
+  // workers never grow it.
+  if (!analyzed_computed_) computeAnalyzed();
+  state_manager_.getBugStates();
+  size_t function_num =
+      std::max(analyzed_.size(), framework::Function::CreatedFunctionNum());
+  if (shared_->function_info.size() < function_num)
+    shared_->function_info.resize(function_num);
+  shared_->has_workers = true;
+
+  auto worker = std::make_unique<Analyzer>(llvm_module_, state_manager_, client);
+  worker->shared_ = shared_;
+  worker->analyzed_computed_ = true;
+  worker->analyzed_ = analyzed_;
+  return worker;
 }
 
 void Analyzer::analyzeFunction(std::shared_ptr<framework::Function> function) {
-  // Add new FunctionInformation Class
-  if (!functionInformationExists(function))
-    function_info_[function] =
+  FusedAnalyzer(llvm_module_, {this}).analyzeFunction(function, {this});
+}
+
+bool Analyzer::beginFunction(std::shared_ptr<framework::Function> function,
+                             bool reanalyze) {
+  if (!analyzes(function)) return false;
+
+  // Add new FunctionInformation Class. When the function is reanalyzed, the
+  // previous information is replaced so that callers analyzed before the
+  // replacement still see the complete result.
+  if (!functionInformationExists(function) ||
+      (reanalyze && functionInfo(function)->Stat() ==
+                        FunctionInformation::ANALYZED))
+    functionInfo(function) =
         std::make_shared<framework::FunctionInformation>(function);
 
-  auto func_info = function_info_[function];
-  if (func_info->Stat() != FunctionInformation::UNANALYZED) return;
+  auto func_info = functionInfo(function);
+  if (func_info->Stat() != FunctionInformation::UNANALYZED) return false;
   func_info->setAnalysisStat(
       framework::FunctionInformation::AnalysisStat::IN_PROGRESS);
 
   analyzing_function_.push(function);
-  /* auto target_blocks = function->BasOrderedicBlocks(); */
-  auto target_blocks = function->OrderedBasicBlocks();
-
-  std::queue<std::shared_ptr<framework::BasicBlock>> block_queue(
-      std::deque(target_blocks.begin(), target_blocks.end()));
-
-  while (!block_queue.empty()) {
-    auto block = block_queue.front();
-    bb_info_ =
-        func_info->createBasicBlockInfo(block, state_manager_.getStates());
-    func_info->setAnayzingBasicBlock(block);
-    analyzePrevBlockBranch(block);
-    for (auto inst : block->Instructions()) {
-      switch (inst->Opcode()) {
-        case llvm::Instruction::Call:
-          analyzeCallInst(inst);
-          break;
-        case llvm::Instruction::Store:
-          analyzeStoreInst(inst);
-          break;
-        case llvm::Instruction::Load:
-          analyzeLoadInst(inst);
-          break;
-        default:
-          break;
-      }
-    }
-    block_queue.pop();
-
-    if (func_info->basicBlockInfoChanged(block)) {
-      block_queue.push(block);
-      continue;
-    }
-
-    generateError(BugNotificationTiming::IMMEDIATE);
-    generateError(BugNotificationTiming::END_OF_LIFE, block->DeadValues());
-  }
+  return true;
+}
 
+void Analyzer::endFunction(std::shared_ptr<framework::Function> function) {
+  auto func_info = functionInfo(function);
   analyzeReturnValue(function);
 
   bb_info_ = func_info->getBasicBlockInformation(function->ReturnBlock());
@@ -133,87 +131,80 @@ void Analyzer::analyzeFunction(std::shared_ptr<framework::Function> function) {
       framework::FunctionInformation::AnalysisStat::ANALYZED);
 }
 
-void Analyzer::analyzePrevBlockBranch(
-    std::shared_ptr<framework::BasicBlock> block) {
-  for (auto pred_reference : block->Predecessors()) {
-    auto preds = pred_reference.lock();
-    if (!preds ||
-        !currentFunctionInformation()->getBasicBlockInformation(preds))
-      continue;
-    /* auto passthrough_blocks = */
-    /*     std::vector<std::shared_ptr<framework::BasicBlock>>(); */
-
-    /* auto weak_blocks = preds->getPassthroughBlock(block); */
-    /* std::transform(weak_blocks.begin(), weak_blocks.end(), */
-    /*                std::back_inserter(passthrough_blocks), */
-    /*                [](const std::weak_ptr<framework::BasicBlock> block) {
-     */
-    /*                  return block.lock(); */
-    /*                }); */
-    /* if (!passthrough_blocks.size()) passthrough_blocks.push_back(preds); */
-
-    /* for (auto passed_block : passthrough_blocks) { */
-    auto branch_inst = preds->getBranchInst();
-    if (!branch_inst || !branch_inst->Condition()) continue;
+void Analyzer::beginBasicBlock(std::shared_ptr<framework::BasicBlock> block) {
+  auto func_info = currentFunctionInformation();
+  bb_info_ = func_info->createBasicBlockInfo(
+      block, state_manager_.SharedStates(), state_manager_.getCustomMerge());
+  func_info->setAnayzingBasicBlock(block);
+  analyzePrevBlockBranch(block);
+}
+
+bool Analyzer::basicBlockChanged(std::shared_ptr<framework::BasicBlock> block) {
+  return currentFunctionInformation()->basicBlockInfoChanged(block);
+}
 
-    auto condition_inst =
-        shared_dyn_cast<framework::CompareInst>(branch_inst->Condition());
-    if (!condition_inst) continue;
+void Analyzer::reportBasicBlock(std::shared_ptr<framework::BasicBlock> block) {
+  generateError(BugNotificationTiming::IMMEDIATE);
+  generateError(BugNotificationTiming::END_OF_LIFE, block->DeadValues());
+}
 
-    bool null_exists = false;
-    std::shared_ptr<framework::Value> comp_value = nullptr;
-    for (auto operand : condition_inst->Operands()) {
-      if (shared_isa<framework::NullValue>(operand)) {
-        null_exists = true;
-        continue;
-      }
-      if (shared_isa<framework::ConstValue>(operand)) continue;
-      comp_value = operand;
-    }
-    if (!comp_value) continue;
+std::shared_ptr<framework::Function> Analyzer::analyzeInstruction(
+    std::shared_ptr<framework::Instruction> I) {
+  switch (I->Opcode()) {
+    case llvm::Instruction::Call:
+      return analyzeCallInst(I);
+    case llvm::Instruction::Store:
+      analyzeStoreInst(I);
+      break;
+    case llvm::Instruction::Load:
+      analyzeLoadInst(I);
+      break;
+    default:
+      break;
+  }
+  return nullptr;
+}
 
-    auto call_inst = shared_dyn_cast<CallInst>(comp_value);
-    if (call_inst && call_inst->CalledFunction() &&
-        Function::IsExpectFunction(call_inst->CalledFunction())) {
-      for (auto args : call_inst->Arguments())
-        generateWarning(call_inst.get(), args.get());
-    }
+void Analyzer::resumeCallInst(std::shared_ptr<framework::Function> called_func,
+                              std::shared_ptr<framework::Instruction> I) {
+  bb_info_ = functionInfo(analyzing_function_.top())
+                 ->getCurrentBasicBlockInformation();
+  copyFunctionValues(called_func,
+                     std::static_pointer_cast<framework::CallInst>(I));
+}
 
-    if (!null_exists) continue;
-    BranchInst::TransitionNodes null_nodes =
-        condition_inst->GetPredicate() == llvm::CmpInst::ICMP_EQ
-            ? branch_inst->TruePathNodes()
-            : branch_inst->FalsePathNodes();
-    StoreValueTransitionRule::StoreValueType type =
-        std::find_if(null_nodes.begin(), null_nodes.end(),
-                     [&block](auto node) { return node.lock() == block; }) !=
-                null_nodes.end()
-            ? StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_NULL
-            : StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_NON_NULL;
+void Analyzer::analyzePrevBlockBranch(
+    std::shared_ptr<framework::BasicBlock> block) {
+  auto func_info = currentFunctionInformation();
+  const auto* facts = func_info->Function()->PredecessorFacts(*block);
+  for (auto& preds : block->Predecessors()) {
+    const auto& edge = *facts++;
+    if (!edge.null_checked) continue;
 
-    // Add semantically correct transitions
-    auto possible_transitions =
-        state_manager_.TransitionManager()->getStoreArgTransitions(type);
+    const auto& pred_info = func_info->getBasicBlockInformation(preds);
+    if (!pred_info) continue;
 
-    auto transitions =
-        state_manager_.TransitionManager()->getStoreArgTransitions(
-            framework::StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_ANY);
+    auto type = edge.is_null
+                    ? StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_NULL
+                    : StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_NON_NULL;
 
-    transitions.insert(transitions.end(), possible_transitions.begin(),
-                       possible_transitions.end());
+    // Add semantically correct transitions
+    TransitionSet transitions(
+        state_manager_.TransitionManager()->getStoreArgTransitions(
+            framework::StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_ANY));
+    transitions.add(
+        state_manager_.TransitionManager()->getStoreArgTransitions(type));
 
     std::set<std::shared_ptr<framework::Value>> related_values =
-        currentFunctionInformation()->GetValueCollection().getRelatedValues(
-            comp_value);
-    related_values.insert(comp_value);
+        func_info->GetValueCollection().getRelatedValues(edge.null_checked);
+    related_values.insert(edge.null_checked);
 
-    if (auto aliased = currentFunctionInformation()
-                           ->getBasicBlockInformation(preds)
-                           ->getAliasValues()
-                           .getAliasInfo(comp_value)) {
+    if (auto aliased =
+            pred_info->getAliasValues().getAliasInfo(edge.null_checked)) {
       related_values.insert(aliased->Values().begin(), aliased->Values().end());
     }
 
+    auto branch_inst = preds->getBranchInst();
     generateWarning(branch_inst.get(), "Branch Inst Transition");
     for (auto value : related_values) {
       changeValueState(transitions, value, branch_inst);
@@ -224,11 +215,11 @@ void Analyzer::analyzePrevBlockBranch(
     int remove_ret_val =
         type == framework::StoreValueTransitionRule::NULL_VAL ? 0 : -1;
     bb_info_->removeReturnvalue(remove_ret_val);
-    /* } */
   }
 }
 
-void Analyzer::analyzeCallInst(std::shared_ptr<framework::Instruction> I) {
+std::shared_ptr<framework::Function> Analyzer::analyzeCallInst(
+    std::shared_ptr<framework::Instruction> I) {
   auto call_inst = std::static_pointer_cast<framework::CallInst>(I);
   /* if (state_manager_.getStatefulConstraint() && */
   /*     !state_manager_.getStatefulConstraint()->shouldPropagateOnCallInst( */
@@ -236,7 +227,7 @@ void Analyzer::analyzeCallInst(std::shared_ptr<framework::Instruction> I) {
   /*   return; */
   /* } */
 
-  if (analyzeFunctionCall(call_inst)) return;
+  if (analyzeFunctionCall(call_inst)) return nullptr;
 
   auto function = call_inst->CalledFunction();
   if (!function) {
@@ -250,20 +241,19 @@ void Analyzer::analyzeCallInst(std::shared_ptr<framework::Instruction> I) {
         bb_info_->removeValueFromState(related, I);
       }
     }
-    return;
+    return nullptr;
   }
 
   if (framework::Function::IsDebugDeclareFunction(function)) {
     bb_info_->resetValueState(call_inst->Arguments()[0], I);
-    return;
+    return nullptr;
   }
 
-  if (function->isDebugFunction()) return;
+  if (function->isDebugFunction()) return nullptr;
 
   // Special Case where memset is called. This is semantically the same as
   // storing something to the target value, so we collect for such info..
   if (Function::IsMemSetFunction(function) && !call_inst->Arguments().empty()) {
-    std::vector<framework::Transition> transitions;
     /* auto target_value = */
     /*     shared_dyn_cast<framework::ConstValue>(call_inst->Arguments()[1]); */
     /* if (target_value && target_value->getConstValue() == 0) { */
@@ -275,12 +265,9 @@ void Analyzer::analyzeCallInst(std::shared_ptr<framework::Instruction> I) {
     /*                      possible_transitions.end()); */
     /* } */
 
-    auto possible_transitions =
+    TransitionSet transitions(
         state_manager_.TransitionManager()->getStoreArgTransitions(
-            framework::StoreValueTransitionRule::ANY);
-
-    transitions.insert(transitions.end(), possible_transitions.begin(),
-                       possible_transitions.end());
+            framework::StoreValueTransitionRule::ANY));
 
     std::set<std::shared_ptr<framework::Value>> related_values =
         currentFunctionInformation()->GetValueCollection().getRelatedValues(
@@ -290,7 +277,7 @@ void Analyzer::analyzeCallInst(std::shared_ptr<framework::Instruction> I) {
     for (auto value : related_values) {
       changeValueState(transitions, value, I);
     }
-    return;
+    return nullptr;
   }
 
   if (function->isDeclaration()) {
@@ -307,58 +294,47 @@ void Analyzer::analyzeCallInst(std::shared_ptr<framework::Instruction> I) {
       }
     }
   } else {
-    if (state_manager_.getStatefulConstraint() &&
-        !state_manager_.getStatefulConstraint()->shouldPropagateOnCallInst(
-            call_inst)) {
-      return;
+    // Calls which cannot fire a transition, and whose result is unused, are
+    // no-ops
+    if (!analyzes(function)) return nullptr;
+
+    if (auto constraint = state_manager_.getStatefulConstraint()) {
+      std::lock_guard<std::mutex> guard(shared_->constraint_mutex);
+      if (!constraint->shouldPropagateOnCallInst(call_inst)) return nullptr;
     }
-    analyzeFunction(function);
-    bb_info_ = function_info_[analyzing_function_.top()]
-                   ->getCurrentBasicBlockInformation();
-    copyFunctionValues(function, call_inst);
+    // The called function is analyzed by the driver, which then resumes
+    // this call instruction through resumeCallInst()
+    return function;
   }
+  return nullptr;
 }
 
 void Analyzer::analyzeStoreInst(std::shared_ptr<framework::Instruction> I) {
   auto store_inst = std::static_pointer_cast<framework::StoreInst>(I);
-  std::vector<framework::Transition> transitions;
+  TransitionSet transitions;
 
   auto value_operand = store_inst->ValueOperand();
   if (framework::shared_isa<framework::NullValue>(value_operand)) {
-    auto possible_transitions =
-        state_manager_.TransitionManager()->getStoreArgTransitions(
-            framework::StoreValueTransitionRule::NULL_VAL);
-
-    transitions.insert(transitions.end(), possible_transitions.begin(),
-                       possible_transitions.end());
+    transitions.add(state_manager_.TransitionManager()->getStoreArgTransitions(
+        framework::StoreValueTransitionRule::NULL_VAL));
   } else {
-    auto possible_transitions =
-        state_manager_.TransitionManager()->getStoreArgTransitions(
-            framework::StoreValueTransitionRule::NON_NULL_VAL);
-
-    transitions.insert(transitions.end(), possible_transitions.begin(),
-                       possible_transitions.end());
+    transitions.add(state_manager_.TransitionManager()->getStoreArgTransitions(
+        framework::StoreValueTransitionRule::NON_NULL_VAL));
   }
 
   if (auto call_inst =
           framework::shared_dyn_cast<framework::CallInst>(value_operand)) {
     auto called_func = call_inst->CalledFunction();
     if (called_func) {
-      auto possible_transitions =
+      transitions.add(
           state_manager_.TransitionManager()->getStoreArgTransitions(
               framework::StoreValueTransitionRule::CALL_FUNC,
-              called_func->Name());
-
-      transitions.insert(transitions.end(), possible_transitions.begin(),
-                         possible_transitions.end());
+              called_func->Name()));
     }
   }
 
-  auto possible_transitions =
-      state_manager_.TransitionManager()->getStoreArgTransitions(
-          framework::StoreValueTransitionRule::ANY);
-  transitions.insert(transitions.end(), possible_transitions.begin(),
-                     possible_transitions.end());
+  transitions.add(state_manager_.TransitionManager()->getStoreArgTransitions(
+      framework::StoreValueTransitionRule::ANY));
 
   std::set<std::shared_ptr<framework::Value>> related_values =
       currentFunctionInformation()->GetValueCollection().getRelatedValues(
@@ -410,7 +386,7 @@ void Analyzer::checkAlias(std::shared_ptr<framework::StoreInst> store_inst) {
     related_values.insert(values.begin(), values.end());
   }
 
-  auto possible_transitions =
+  const auto& possible_transitions =
       state_manager_.TransitionManager()->getAliasTransitions();
   for (auto value : related_values) {
     changeValueState(possible_transitions, value, store_inst);
@@ -419,7 +395,7 @@ void Analyzer::checkAlias(std::shared_ptr<framework::StoreInst> store_inst) {
 
 void Analyzer::analyzeLoadInst(std::shared_ptr<framework::Instruction> I) {
   auto load_inst = std::static_pointer_cast<framework::LoadInst>(I);
-  auto transitions =
+  const auto& transitions =
       state_manager_.TransitionManager()->getUseValueTransitions();
 
   changeValueState(transitions, load_inst->LoadValue(), I);
@@ -427,10 +403,22 @@ void Analyzer::analyzeLoadInst(std::shared_ptr<framework::Instruction> I) {
 
 bool Analyzer::functionInformationExists(
     std::shared_ptr<framework::Function> function) {
-  return function_info_.find(function) != function_info_.end();
+  return function->Id() < shared_->function_info.size() &&
+         shared_->function_info[function->Id()];
 }
 
-void Analyzer::changeValueState(std::vector<Transition> transitions,
+std::shared_ptr<FunctionInformation>& Analyzer::functionInfo(
+    const std::shared_ptr<framework::Function>& function) {
+  auto& function_info = shared_->function_info;
+  if (function->Id() >= function_info.size()) {
+    // Workers index into the vector concurrently
+    assert(!shared_->has_workers);
+    function_info.resize(function->Id() + 1);
+  }
+  return function_info[function->Id()];
+}
+
+void Analyzer::changeValueState(const TransitionSet& transitions,
                                 std::shared_ptr<Value> value,
                                 std::shared_ptr<framework::Instruction> inst) {
   if (value->isGlobalVar() || transitions.empty()) return;
@@ -449,30 +437,33 @@ void Analyzer::generateError(
     const std::set<std::shared_ptr<framework::Value>> values) {
   for (auto state : state_manager_.getBugStates()) {
     if (state.NotificationTiming() != timing) continue;
+    // Reported in the order the values were managed in, see PersistentMap
     for (auto value : bb_info_->getValueTransitionStates(state)) {
-      if (!values.empty() && values.find(value.first) == values.end()) continue;
-      if (value.second->CurrentState() != state) continue;
-      if (!value.second->LeastSignificantSource().isInitState()) continue;
-      /* if (!value.second->ReducedTransition().Source().isInitState()) continue; */
+      auto& logs = value.logs;
+      if (!values.empty() && values.find(value.value) == values.end()) continue;
+      if (logs.CurrentState() != state) continue;
+      if (!logs.LeastSignificantSource().isInitState()) continue;
+      /* if (!logs.ReducedTransition().Source().isInitState()) continue; */
 
       if (state.getTriggerConstraint() == TriggerConstraint::NON_RETURN &&
-          value.first ==
+          value.value ==
               currentFunctionInformation()->Function()->getReturnValue()) {
         continue;
       }
 
       if (framework::CommandLineArgs::Flex ||
-          !value.first->isArbitaryArrayElement()) {
+          !value.value->isArbitaryArrayElement()) {
         llvm::raw_string_ostream log_stream = log_.raw_stream();
         framework::generateError(log_stream,
-                                 value.second->CurrentInstruction().get(),
+                                 logs.CurrentInstruction().get(),
                                  "--- [" + state.Name() + "] ---");
         framework::generateError(log_stream,
-                                 value.second->CurrentInstruction().get(),
-                                 value.first.get());
-        value.second->generateLog(log_stream);
+                                 logs.CurrentInstruction().get(),
+                                 value.value.get());
+        logs.generateLog(log_stream);
       }
-      value.second->logicalTerminate(value.second->CurrentInstruction());
+      logs.logicalTerminate(logs.CurrentInstruction());
+      bb_info_->setValueTransitionState(value);
     }
   }
 }
@@ -481,7 +472,7 @@ void Analyzer::copyFunctionValues(
     std::shared_ptr<framework::Function> called_func,
     std::shared_ptr<framework::CallInst> call_inst) {
   if (!functionInformationExists(called_func)) return;
-  auto called_func_info = function_info_[called_func];
+  auto called_func_info = functionInfo(called_func);
 
   if (called_func->ProtectedRefcountValue() &&
       called_func->lastRefcountInstruction() != call_inst) {
@@ -498,7 +489,8 @@ void Analyzer::copyFunctionValues(
   if (success_blocks.empty()) return;
 
   auto operands = call_inst->Arguments();
-  ArgValueStates pending_states(operands.size(), state_manager_.getStates());
+  ArgValueStates pending_states(operands.size(),
+                                state_manager_.SharedStates());
   for (auto success_block_ref : success_blocks) {
     auto success_block = success_block_ref.lock();
     if (!success_block) continue;
@@ -527,7 +519,7 @@ void Analyzer::copyFunctionValues(
   }
 
   generateWarning(call_inst.get(), "Call Inst Here");
-  for (int i = 0; i < operands.size(); i++) {
+  for (size_t i = 0; i < operands.size(); i++) {
     auto operand = operands[i];
     for (auto value : pending_states.getValueStateForArg(i)) {
       auto new_value = Value::CreateAppend(operand, value.first);
@@ -548,9 +540,14 @@ bool Analyzer::addPendingFunctionValues(
 
   generateWarning(call_inst.get(), "Found BranchInst");
 
-  int compared_value = framework::FunctionInformation::kSuccessCode;
-  llvm::CmpInst::Predicate predicate = llvm::CmpInst::Predicate::ICMP_NE;
-  bool is_null_value = false;
+  // The constant compared with is taken from the facts of the branch, which
+  // default to the success code
+  const auto& facts =
+      currentFunctionInformation()->Function()->getBranchFacts(
+          *currentFunctionInformation()->currentBasicBlock());
+  int compared_value = facts.compared_value;
+  llvm::CmpInst::Predicate predicate = facts.predicate;
+  bool is_null_value = facts.is_null;
 
   if (auto compare_inst = framework::shared_dyn_cast<framework::CompareInst>(
           branch_inst->Condition())) {
@@ -559,20 +556,12 @@ bool Analyzer::addPendingFunctionValues(
     }
     generateWarning(call_inst.get(), "Found CompareInst");
 
-    predicate = compare_inst->GetPredicate();
-
-    auto operand = std::find_if(
-        compare_inst->Operands().begin(), compare_inst->Operands().end(),
-        [call_inst](auto operand) { return operand != call_inst; });
-
-    if (operand == compare_inst->Operands().end()) return false;
-
-    if (auto const_value =
-            framework::shared_dyn_cast<framework::ConstValue>(*operand)) {
-      compared_value = const_value->getConstValue();
-    } else if (framework::shared_isa<framework::NullValue>(*operand)) {
-      is_null_value = true;
-    }
+    if (std::find_if(compare_inst->Operands().begin(),
+                     compare_inst->Operands().end(),
+                     [call_inst](auto operand) {
+                       return operand != call_inst;
+                     }) == compare_inst->Operands().end())
+      return false;
   } else if (framework::shared_isa<framework::CallInst>(
                  branch_inst->Condition())) {
     if (call_inst != branch_inst->Condition()) return false;
@@ -580,7 +569,7 @@ bool Analyzer::addPendingFunctionValues(
   }
 
   if (!functionInformationExists(called_func)) return false;
-  auto called_func_info = function_info_[called_func];
+  auto called_func_info = functionInfo(called_func);
   generateWarning(call_inst.get(), "Found called func info");
 
   auto basic_block_info =
@@ -659,17 +648,21 @@ bool Analyzer::analyzeFunctionCall(
   auto function = call_inst->CalledFunction();
   if (!function || call_inst->Arguments().empty()) return false;
 
+  auto callee_transitions =
+      state_manager_.TransitionManager()->getCalleeTransitions(
+          function->Name());
+  if (!callee_transitions) return false;
+
   bool changed = false;
-  for (int arg = 0; arg < call_inst->Arguments().size(); arg++) {
-    const std::pair<FunctionArgTransitionRule::FunctionArg,
-                    std::vector<framework::Transition>>
-        transitions =
-            state_manager_.TransitionManager()->getFunctionArgTransitions(
-                function->Name(), arg);
-    changed = changed || !transitions.second.empty();
+  size_t arg_size =
+      std::min(call_inst->Arguments().size(), callee_transitions->size());
+  for (size_t arg = 0; arg < arg_size; arg++) {
+    auto transitions = (*callee_transitions)[arg];
+    if (!transitions || transitions->second.empty()) continue;
+    changed = true;
 
     std::set<std::shared_ptr<framework::Value>> args;
-    if (transitions.first.consider_parent) {
+    if (transitions->first.consider_parent) {
       args = currentFunctionInformation()->GetValueCollection().getParentValues(
           call_inst->Arguments()[arg]);
     }
@@ -677,7 +670,7 @@ bool Analyzer::analyzeFunctionCall(
     args.insert(call_inst->Arguments()[arg]);
 
     for (auto &value : args) {
-      changeValueState(transitions.second, value, call_inst);
+      changeValueState(transitions->second, value, call_inst);
     }
   }
   return changed;
@@ -695,8 +688,8 @@ void Analyzer::analyzeReturnValue(
     return;
   }
 
-  std::set<std::weak_ptr<framework::BasicBlock>> pred_block(
-      return_block->Predecessors());
+  std::vector<std::shared_ptr<framework::BasicBlock>> pred_block(
+      return_block->Predecessors().begin(), return_block->Predecessors().end());
 
   /* if (pred_block.empty() || !return_block->Instructions().empty()) { */
   /*   pred_block.insert(return_block); */
@@ -707,85 +700,106 @@ void Analyzer::analyzeReturnValue(
   }
 
   if (pred_block.empty()) {
-    pred_block.insert(return_block);
+    pred_block.push_back(return_block);
   }
 
-  for (auto pred_reference : pred_block) {
-    if (auto pred = pred_reference.lock()) {
-      if (!pred->Instructions().empty()) {
-        generateWarning(pred->Instructions().front().get(),
-                        "Pred Block analysis");
-      }
+  for (auto pred : pred_block) {
+    if (!pred->Instructions().empty()) {
+      generateWarning(pred->Instructions().front().get(),
+                      "Pred Block analysis");
+    }
 
-      auto block_info = func_info->getBasicBlockInformation(pred);
-      if (!block_info) continue;
-      if (block_info->ReturnValues().empty()) {
-        func_info->addReturnValueInfo(FunctionInformation::kSuccessCode, pred);
-        func_info->addReturnValueInfo(FunctionInformation::kErrorCode, pred);
-        continue;
-      }
+    auto block_info = func_info->getBasicBlockInformation(pred);
+    if (!block_info) continue;
+    if (block_info->ReturnValues().empty()) {
+      func_info->addReturnValueInfo(FunctionInformation::kSuccessCode, pred);
+      func_info->addReturnValueInfo(FunctionInformation::kErrorCode, pred);
+      continue;
+    }
 
-      for (auto return_value : block_info->ReturnValues()) {
-        if (auto const_int = framework::shared_dyn_cast<framework::ConstValue>(
-                return_value)) {
-          auto value = const_int->getConstValue();
-          generateWarning(std::to_string(value));
-          if (block_info->ReturnValueSatisfiable(value))
-            func_info->addReturnValueInfo(value, pred);
-        } else if (auto const_null =
-                       framework::shared_dyn_cast<framework::NullValue>(
-                           return_value)) {
-          func_info->addReturnValueInfo(FunctionInformation::kErrorCode, pred);
-          // Add the value to the list
-        } else if (auto call_inst =
-                       framework::shared_dyn_cast<framework::CallInst>(
-                           return_value)) {
-          auto called_function = call_inst->CalledFunction();
-          if (called_function) {
-            if (called_function->isErrorFunction()) {
-              func_info->addReturnValueInfo(FunctionInformation::kErrorCode,
-                                            pred);
-              continue;
-            }
-
-            auto called_func_info = getFunctionInformation(called_function);
-            if (!called_func_info) {
-              /* func_info->addReturnValueInfo(FunctionInformation::kErrorCode,
-               */
-              /*                               pred); */
-              /* func_info->addReturnValueInfo(FunctionInformation::kSuccessCode,
-               */
-              /*                               pred); */
-              continue;
-            }
-
-            for (auto return_value : called_func_info->getReturnValueInfo()) {
-              /* func_info->addReturnValueInfo(return_value.first, */
-              /*                               return_value.second); */
-              if (block_info->ReturnValueSatisfiable(return_value.first))
-                func_info->addReturnValueInfo(return_value.first, pred);
-            }
-          }
-          // Decode the call_inst by chaning
-        } else {
-          if (return_value->getValueID() > 0) {
-            func_info->addReturnValueInfo(FunctionInformation::kSuccessCode,
-                                          pred);
+    for (auto return_value : block_info->ReturnValues()) {
+      if (auto const_int = framework::shared_dyn_cast<framework::ConstValue>(
+              return_value)) {
+        auto value = const_int->getConstValue();
+        generateWarning(std::to_string(value));
+        if (block_info->ReturnValueSatisfiable(value))
+          func_info->addReturnValueInfo(value, pred);
+      } else if (auto const_null =
+                     framework::shared_dyn_cast<framework::NullValue>(
+                         return_value)) {
+        func_info->addReturnValueInfo(FunctionInformation::kErrorCode, pred);
+        // Add the value to the list
+      } else if (auto call_inst =
+                     framework::shared_dyn_cast<framework::CallInst>(
+                         return_value)) {
+        auto called_function = call_inst->CalledFunction();
+        if (called_function) {
+          if (called_function->isErrorFunction()) {
             func_info->addReturnValueInfo(FunctionInformation::kErrorCode,
                                           pred);
+            continue;
+          }
+
+          auto called_func_info = getFunctionInformation(called_function);
+          if (!called_func_info) {
+            /* func_info->addReturnValueInfo(FunctionInformation::kErrorCode,
+             */
+            /*                               pred); */
+            /* func_info->addReturnValueInfo(FunctionInformation::kSuccessCode,
+             */
+            /*                               pred); */
+            continue;
+          }
+
+          for (auto return_value : called_func_info->getReturnValueInfo()) {
+            /* func_info->addReturnValueInfo(return_value.first, */
+            /*                               return_value.second); */
+            if (block_info->ReturnValueSatisfiable(return_value.first))
+              func_info->addReturnValueInfo(return_value.first, pred);
           }
-          // is success block
         }
+        // Decode the call_inst by chaning
+      } else {
+        if (return_value->getValueID() > 0) {
+          func_info->addReturnValueInfo(FunctionInformation::kSuccessCode,
+                                        pred);
+          func_info->addReturnValueInfo(FunctionInformation::kErrorCode,
+                                        pred);
+        }
+        // is success block
       }
     }
   }
 }
 
+bool Analyzer::analyzes(const std::shared_ptr<framework::Function>& function) {
+  if (!analyzed_computed_) computeAnalyzed();
+  return function->Id() >= analyzed_.size() || analyzed_[function->Id()];
+}
+
+void Analyzer::computeAnalyzed() {
+  analyzed_computed_ = true;
+  auto module_ir = ir_generator::IRGenerator::framework_ir_.find(&llvm_module_);
+  if (module_ir == ir_generator::IRGenerator::framework_ir_.end()) return;
+
+  auto transition_manager = state_manager_.TransitionManager();
+  auto functions = StateTransitionManager::AnalyzedFunctions(
+      llvm_module_, transition_manager->CalleeNames(),
+      transition_manager->UncalledTriggers(false));
+
+  // Declarations only trigger through their name, and defined functions
+  // outside of the module IR were skipped by the framework prescan
+  for (auto& [llvm_function, function] : Function::CreatedFunctions()) {
+    if (function->Id() >= analyzed_.size())
+      analyzed_.resize(function->Id() + 1, false);
+    analyzed_[function->Id()] = functions.find(llvm_function) != functions.end();
+  }
+}
+
 std::shared_ptr<FunctionInformation> Analyzer::getFunctionInformation(
     std::shared_ptr<framework::Function> function) {
-  auto func_info = function_info_.find(function);
-  if (func_info != function_info_.end()) return func_info->second;
-  return nullptr;
+  if (!functionInformationExists(function)) return nullptr;
+  return shared_->function_info[function->Id()];
 }
 
 }  // namespace framework
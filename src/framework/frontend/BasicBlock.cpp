@@ -44,17 +44,18 @@
 
 #include "core/Casting.hpp"
 #include "core/Function.hpp"
+#include "core/Hashing.hpp"
 #include "frontend/BasicBlock.hpp"
 
 namespace framework {
 BasicBlockInformation::BasicBlockInformation(
     std::shared_ptr<framework::BasicBlock> basic_block,
-    const std::set<State>& states)
+    std::shared_ptr<const std::set<State>> states)
     : basic_block_(basic_block),
       is_partial_states_(false),
       predecessor_partial_(false),
-      states_(states),
       arg_value_states_(0, states),
+      states_(states),
       status_(NONE) {
   uint64_t arg_size = 0;
   if (auto function = basic_block_->Parent().lock()) {
@@ -75,7 +76,7 @@ BasicBlockInformation::BasicBlockInformation(const BasicBlockInformation& info)
 }
 
 bool BasicBlockInformation::changeValueState(
-    std::vector<Transition>& transitions,
+    const TransitionSet& transitions,
     std::shared_ptr<framework::Value> value,
     std::shared_ptr<framework::Instruction> instruction) {
   bool changed = false;
@@ -139,7 +140,7 @@ void BasicBlockInformation::setPendingValueStates(
   pending_values_[basic_block].arg_states.addArgValueState(arg_value_state);
 }
 
-std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
+std::vector<ValueTransitionState>
 BasicBlockInformation::getValueTransitionStates(const State& state) {
   auto value_transition_states = value_states_.getValueTransitionStates(state);
   if (state.EarlyNotification()) {
@@ -153,6 +154,15 @@ BasicBlockInformation::getValueTransitionStates(const State& state) {
   return value_transition_states;
 }
 
+void BasicBlockInformation::setValueTransitionState(
+    const ValueTransitionState& state) {
+  if (state.entry_state) {
+    arg_value_states_.setTransitionLog(state);
+    return;
+  }
+  value_states_.setValueState(state.value, state.logs);
+}
+
 void BasicBlockInformation::setPendingReturnValues(
     std::weak_ptr<framework::BasicBlock> basic_block,
     std::shared_ptr<framework::ConstValue> arg_value_state) {
@@ -182,7 +192,7 @@ BasicBlockInformation::ValueStatesForSuccessor(
   }
 
   auto operands = call_inst->Arguments();
-  for (int i = 0; i < operands.size(); i++) {
+  for (size_t i = 0; i < operands.size(); i++) {
     auto operand = operands[i];
     for (auto value :
          pending_values_[successor].arg_states.getValueStateForArg(i)) {
@@ -227,75 +237,69 @@ BasicBlockInformation::ReturnCodeForSuccessor(
   return return_values;
 }
 
-BasicBlockValueStates::BasicBlockValueStates(
-    const BasicBlockValueStates& states)
-    : value_states_(states.value_states_) {}
-
 bool BasicBlockValueStates::operator==(const BasicBlockValueStates& states) {
   return value_states_ == states.value_states_;
 }
 
 bool BasicBlockValueStates::valueExists(
     std::shared_ptr<framework::Value> value) {
-  return value_states_.find(value) != value_states_.end();
+  return value_states_.contains(value);
 }
 
 void BasicBlockValueStates::setValueState(
-    std::shared_ptr<framework::Value> value, framework::Transition& transition,
+    std::shared_ptr<framework::Value> value,
+    const framework::Transition& transition,
     std::shared_ptr<framework::Instruction> instruction) {
-  value_states_[value].addTransition(transition, instruction);
+  TransitionLogs logs;
+  if (auto current_logs = value_states_.lookup(value)) logs = *current_logs;
+  logs.addTransition(transition, instruction);
+  value_states_.set(value, logs);
 }
 
 void BasicBlockValueStates::setValueState(
-    std::shared_ptr<framework::Value> value, framework::TransitionLogs& logs) {
-  value_states_[value] = logs;
+    std::shared_ptr<framework::Value> value,
+    const framework::TransitionLogs& logs) {
+  value_states_.set(value, logs);
 }
 
-TransitionLogs& BasicBlockValueStates::getTransitionLog(
-    std::shared_ptr<framework::Value> value) {
-  return value_states_[value];
+const TransitionLogs& BasicBlockValueStates::getTransitionLog(
+    std::shared_ptr<framework::Value> value) const {
+  static const TransitionLogs kNoLogs;
+  auto logs = value_states_.lookup(value);
+  return logs ? *logs : kNoLogs;
 }
 
 std::vector<std::shared_ptr<framework::Value>>
 BasicBlockValueStates::getStateValues(const framework::State& state) {
   std::vector<std::shared_ptr<framework::Value>> values;
-  for (auto value = value_states_.begin(); value != value_states_.end();
-       value++) {
-    if (value->second.CurrentState() == state) values.push_back(value->first);
+  for (const auto& value : value_states_) {
+    if (value.second.CurrentState() == state) values.push_back(value.first);
   }
   return values;
 }
 
-std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
+std::vector<ValueTransitionState>
 BasicBlockValueStates::getValueTransitionStates(const framework::State& state) {
-  std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
-      values;
-  for (auto value = value_states_.begin(); value != value_states_.end();
-       value++) {
-    if (value->second.CurrentState() == state)
-      values.push_back(std::make_pair(value->first, &(value->second)));
-  }
+  std::vector<ValueTransitionState> values;
+  for (auto value : getStateValues(state))
+    values.push_back({value, *value_states_.lookup(value)});
   return values;
 }
 
 bool BasicBlockValueStates::transitionState(
-    std::vector<Transition>& transitions,
+    const TransitionSet& transitions,
     std::shared_ptr<framework::Value> value,
     std::shared_ptr<framework::Instruction> instruction) {
   generateWarning(instruction.get(), "Transition State Called");
   if (valueExists(value)) {
     generateWarning(instruction.get(), "value exists");
     const State& current_state = getState(value);
-    const TransitionLogs& current_transitions = value_states_[value];
+    const TransitionLogs& current_transitions = *value_states_.lookup(value);
 
     // Search for possible transitions
-    auto next_transition =
-        std::find_if(transitions.begin(), transitions.end(),
-                     [&current_state](Transition transition) {
-                       return transition.Source() == current_state;
-                     });
+    auto next_transition = transitions.find(current_state);
 
-    if (next_transition != transitions.end() &&
+    if (next_transition &&
         current_transitions.CurrentInstruction() != instruction &&
         *current_transitions.CurrentInstruction() <= *instruction) {
       setValueState(value, *next_transition, instruction);
@@ -304,20 +308,7 @@ bool BasicBlockValueStates::transitionState(
     return false;
   }
 
-  framework::Transition* transition = nullptr;
-  auto init_transition = transitions.begin();
-
-  while (init_transition != transitions.end()) {
-    if (init_transition->Source().isInitState() &&
-        (!transition || init_transition->Target() < transition->Target()))
-      transition = &(*init_transition);
-    init_transition = std::find_if(init_transition + 1, transitions.end(),
-                                   [](Transition transition) {
-                                     return transition.Source().isInitState();
-                                   });
-  }
-
-  if (transition) {
+  if (auto transition = transitions.InitTransition()) {
     setValueState(value, *transition, instruction);
     return true;
   }
@@ -334,17 +325,23 @@ void BasicBlockValueStates::print() {
 /* ArgTransitions Class */
 ArgTransitions::ArgTransitions() : transition_per_state_() {}
 
-ArgTransitions::ArgTransitions(std::set<framework::State> states) {
-  for (auto state : states) transition_per_state_[state] = TransitionLogs();
-}
-
-ArgTransitions::ArgTransitions(const ArgTransitions& arg_transitions)
-    : transition_per_state_(arg_transitions.transition_per_state_) {}
+ArgTransitions::ArgTransitions(
+    std::shared_ptr<const std::set<framework::State>> states)
+    : states_(states) {}
 
 bool ArgTransitions::operator==(const ArgTransitions& arg_transitions) const {
   return transition_per_state_ == arg_transitions.transition_per_state_;
 }
 
+uint64_t ArgTransitions::Fingerprint() const {
+  uint64_t fingerprint = 0;
+  for (const auto& state : transition_per_state_) {
+    fingerprint = HashCombine(fingerprint, state.first.Fingerprint());
+    fingerprint = HashCombine(fingerprint, state.second.Fingerprint());
+  }
+  return fingerprint;
+}
+
 void ArgTransitions::addArgTransitions(const ArgTransitions& arg_transitions) {
   for (auto state : arg_transitions.transition_per_state_) {
     if (state.second.isDummy()) continue;
@@ -358,30 +355,46 @@ void ArgTransitions::addArgTransitions(const ArgTransitions& arg_transitions) {
 }
 
 bool ArgTransitions::addTransition(
-    std::vector<Transition>& transitions,
+    const TransitionSet& transitions,
     std::shared_ptr<framework::Instruction> inst) {
   bool changed = false;
   for (auto& state : transition_per_state_) {
-    State current_state = state.first;
-    if (!state.second.isDummy()) current_state = state.second.CurrentState();
-
     // Search for possible transitions
-    auto next_transition =
-        std::find_if(transitions.begin(), transitions.end(),
-                     [&current_state](Transition transition) {
-                       return transition.Source() == current_state;
-                     });
+    auto next_transition = transitions.find(state.second.CurrentState());
 
-    if (next_transition != transitions.end()) {
+    if (next_transition) {
       state.second.addTransition(*next_transition, inst);
       changed = true;
     }
   }
+  if (!states_ || transitions.empty()) return changed;
+
+  // Entry states without logs yet start one when a transition fires from
+  // them. Each count of a counter is an entry state of its own.
+  for (auto& states : *states_) {
+    for (int count = 0; count < states.CountNum(); count++) {
+      State state = states.isCounter() ? states.WithCount(count) : states;
+      if (transition_per_state_.find(state) != transition_per_state_.end())
+        continue;
+      if (auto next_transition = transitions.find(state)) {
+        transition_per_state_.emplace(state,
+                                      TransitionLogs(*next_transition, inst));
+        changed = true;
+      }
+    }
+  }
   return changed;
 }
 
 TransitionLogs ArgTransitions::getTransitionLog(State state) {
-  return transition_per_state_[state];
+  auto logs = transition_per_state_.find(state);
+  if (logs == transition_per_state_.end()) return TransitionLogs();
+  return logs->second;
+}
+
+void ArgTransitions::setTransitionLog(const State& state,
+                                      const TransitionLogs& logs) {
+  transition_per_state_[state] = logs;
 }
 
 TransitionLogs getTransitionLog(State state);
@@ -390,7 +403,8 @@ TransitionLogs getTransitionLog(State state);
 ArgValueStates::ArgValueStates() : value_states_(0) {}
 /* ArgValueStates::ArgValueStates(uint64_t arg_num) : value_states_(arg_num) {}
  */
-ArgValueStates::ArgValueStates(uint64_t arg_num, const std::set<State>& states)
+ArgValueStates::ArgValueStates(uint64_t arg_num,
+                               std::shared_ptr<const std::set<State>> states)
     : value_states_(arg_num), states_(states) {}
 
 ArgValueStates::ArgValueStates(const ArgValueStates& arg_value_states)
@@ -404,9 +418,9 @@ ArgValueStates& ArgValueStates::operator=(
   return *this;
 }
 
-const std::map<std::shared_ptr<framework::Value>, std::vector<Transition>>
-ArgValueStates::getValueStateForArg(int64_t index) const {
-  std::map<std::shared_ptr<framework::Value>, std::vector<Transition>> new_map;
+const std::map<std::shared_ptr<framework::Value>, TransitionTable>
+ArgValueStates::getValueStateForArg(size_t index) const {
+  std::map<std::shared_ptr<framework::Value>, TransitionTable> new_map;
 
   if (value_states_.size() <= index) return new_map;
   for (auto value : value_states_[index]) {
@@ -414,8 +428,7 @@ ArgValueStates::getValueStateForArg(int64_t index) const {
       if (!transition_log.second.isDummy() &&
           transition_log.second.ReducedTransition().Source() !=
           transition_log.second.ReducedTransition().Target()) {
-        new_map[value.first].push_back(
-            transition_log.second.ReducedTransition());
+        new_map[value.first].add(transition_log.second.ReducedTransition());
       }
     }
   }
@@ -433,63 +446,62 @@ ArgValueStates::getValueStateForArg(int64_t index) const {
 /*   return value_states_[index]; */
 /* } */
 
-const std::map<std::shared_ptr<framework::Value>, ArgTransitions>
-ArgValueStates::getArgTransitions(int64_t index) const {
-  if (value_states_.size() <= index)
-    return std::map<std::shared_ptr<framework::Value>, ArgTransitions>();
+const ArgValueStates::ArgTransitionMap ArgValueStates::getArgTransitions(
+    size_t index) const {
+  if (value_states_.size() <= index) return ArgTransitionMap();
   return value_states_[index];
 }
 
-std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
-ArgValueStates::getValueTransitionStates(const framework::State& state) {
-  std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
-      values;
-  for (auto& value_states : value_states_) {
-    for (auto value = value_states.begin(); value != value_states.end();
-         value++) {
-      auto& transition_per_state = value->second.TransitionPerState();
-      for (auto& transition_logs : transition_per_state) {
+std::vector<ValueTransitionState> ArgValueStates::getValueTransitionStates(
+    const framework::State& state) const {
+  std::vector<ValueTransitionState> values;
+  for (size_t arg_index = 0; arg_index < value_states_.size(); arg_index++) {
+    for (const auto& value : value_states_[arg_index]) {
+      for (const auto& transition_logs : value.second.TransitionPerState()) {
         if (transition_logs.second.isDummy()) continue;
         if (transition_logs.second.LeastSignificantSource().isInitState()) {
           if (transition_logs.second.MostSignificantTarget() == state) {
-            values.push_back(
-                std::make_pair(value->first, &(transition_logs.second)));
+            values.push_back({value.first, transition_logs.second,
+                              static_cast<int64_t>(arg_index),
+                              transition_logs.first});
           }
         }
       }
-      /* std::vector<TransitionLogs*> new_logs; */
-      /* for (framework::TransitionLogs& log : value->second) { */
-      /*   if (log.LeastSignificantSource().isInitState()) { */
-      /*     if (log.MostSignificantTarget() == state) { */
-      /*       new_logs.push_back(&log); */
-      /*     } */
-      /*   } */
-      /* } */
-
-      /* for (auto log : new_logs) */
-      /*   values.push_back(std::make_pair(value->first, log)); */
     }
   }
   return values;
 }
 
+void ArgValueStates::setTransitionLog(const ValueTransitionState& state) {
+  auto& arg_states = value_states_[state.arg_index];
+  auto current = arg_states.lookup(state.value);
+  if (!current) return;
+
+  ArgTransitions arg_transitions = *current;
+  arg_transitions.setTransitionLog(*state.entry_state, state.logs);
+  arg_states.set(state.value, arg_transitions);
+}
+
 bool ArgValueStates::ValueExistsInArg(uint64_t arg,
                                       std::shared_ptr<Value> value) {
   if (value_states_.size() <= arg) return false;
-  return value_states_[arg].find(value) != value_states_[arg].end();
+  return value_states_[arg].contains(value);
 }
 
 void ArgValueStates::addArgValueState(const ArgValueStates& states) {
-  for (auto arg_idx = 0;
+  for (size_t arg_idx = 0;
        arg_idx < std::min(value_states_.size(), states.Size()); arg_idx++) {
     for (auto& value_transitions : states.getArgTransitions(arg_idx)) {
       const std::shared_ptr<Value> value = value_transitions.first;
       ArgTransitions arg_transitions = value_transitions.second;
 
-      if (ValueExistsInArg(arg_idx, value))
-        value_states_[arg_idx][value].addArgTransitions(arg_transitions);
-      else
-        value_states_[arg_idx][value] = ArgTransitions(arg_transitions);
+      if (auto current = value_states_[arg_idx].lookup(value)) {
+        ArgTransitions merged = *current;
+        merged.addArgTransitions(arg_transitions);
+        value_states_[arg_idx].set(value, merged);
+      } else {
+        value_states_[arg_idx].set(value, arg_transitions);
+      }
 
       /* for (auto trans: value_states_[arg_idx][value].TransitionPerState()) {
        */
@@ -530,18 +542,22 @@ void ArgValueStates::addArgValueState(const ArgValueStates& states) {
 }
 
 bool ArgValueStates::transitionState(
-    std::vector<Transition>& transitions,
+    const TransitionSet& transitions,
     std::shared_ptr<framework::Value> value,
     std::shared_ptr<framework::Instruction> instruction) {
   if (auto argument = framework::shared_dyn_cast<framework::Argument>(value)) {
     uint64_t arg_index = argument->ArgNum();
     if (value_states_.size() <= arg_index) return false;
 
-    if (!ValueExistsInArg(arg_index, value))
-      value_states_[arg_index][value] = ArgTransitions(states_);
+    ArgTransitions arg_transitions(states_);
+    if (auto current = value_states_[arg_index].lookup(value))
+      arg_transitions = *current;
+    else
+      value_states_[arg_index].set(value, arg_transitions);
 
-    return value_states_[arg_index][value].addTransition(transitions,
-                                                         instruction);
+    if (!arg_transitions.addTransition(transitions, instruction)) return false;
+    value_states_[arg_index].set(value, arg_transitions);
+    return true;
 
     /* std::set<int> updated_logs; */
     /* std::vector<TransitionLogs> new_logs; */
@@ -586,6 +602,13 @@ bool ArgValueStates::operator==(const ArgValueStates& states) {
   return value_states_ == states.value_states_;
 }
 
+uint64_t ArgValueStates::Fingerprint() const {
+  uint64_t fingerprint = value_states_.size();
+  for (const auto& arg_states : value_states_)
+    fingerprint = HashCombine(fingerprint, arg_states.fingerprint());
+  return fingerprint;
+}
+
 bool BasicBlockInformation::operator==(
     const framework::BasicBlockInformation& prev_block_info) {
   return value_states_ == prev_block_info.value_states_ &&
@@ -593,6 +616,16 @@ bool BasicBlockInformation::operator==(
          return_values_ == prev_block_info.return_values_;
 }
 
+uint64_t BasicBlockInformation::Fingerprint() const {
+  uint64_t fingerprint =
+      HashCombine(value_states_.Fingerprint(), arg_value_states_.Fingerprint());
+  for (const auto& value : return_values_) {
+    fingerprint = HashCombine(fingerprint,
+                              reinterpret_cast<uintptr_t>(value.get()));
+  }
+  return fingerprint;
+}
+
 void BasicBlockInformation::addReturnValues(
     const std::set<std::shared_ptr<framework::Value>>& return_values) {
   return_values_.insert(return_values.begin(), return_values.end());
@@ -29,6 +29,7 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <iostream>
@@ -45,6 +46,7 @@
 #include "BasicBlock.hpp"
 #include "Framework.hpp"
 #include "Function.hpp"
+#include "FusedAnalyzer.hpp"
 #include "IRGenerator.hpp"
 #include "Logs.hpp"
 #include "State.hpp"
@@ -52,11 +54,21 @@
 #include "Utils.hpp"
 #include "Value.hpp"
 #include "ValueTypeAlias.hpp"
+#include "core/SFG/Converter.hpp"
 #include "framework_ir/IRGenerator.hpp"
 
 static llvm::cl::opt<bool> Async(
     "async", llvm::cl::desc("Asynchronously conduct analysis"));
 
+static llvm::cl::opt<bool> Fused(
+    "fused", llvm::cl::desc("Analyze every state manager in lockstep on one "
+                            "thread, sharing the block and call order"));
+
+static llvm::cl::opt<unsigned> Threads(
+    "analyzer-threads",
+    llvm::cl::desc("Run analyzers on N threads instead of forking processes"),
+    llvm::cl::init(0));
+
 static llvm::cl::opt<bool> MeasureTime("measure",
                                        llvm::cl::desc("Measure analysis time"));
 
@@ -79,24 +91,104 @@ struct AnalyzerInfo {
   void run_analyzer() { inner_analyzer->analyze(); }
 };
 
-FrameworkPass::FrameworkPass() : ModulePass(ID) {}
+// Run the analyzers on a bounded number of threads sharing the framework IR.
+// Each thread keeps taking the next analyzer until none are left.
+static void runAnalyzerThreads(std::vector<AnalyzerInfo> &analyzers,
+                               unsigned thread_num) {
+  std::atomic<size_t> next_analyzer(0);
+  std::vector<std::thread> workers;
+  thread_num = std::min<size_t>(thread_num, analyzers.size());
+
+  for (unsigned i = 0; i < thread_num; i++) {
+    workers.emplace_back([&analyzers, &next_analyzer]() {
+      for (size_t index = next_analyzer++; index < analyzers.size();
+           index = next_analyzer++) {
+        analyzers[index].run_analyzer();
+      }
+    });
+  }
+
+  for (auto &worker : workers) worker.join();
+}
+
+FrameworkPass::FrameworkPass() : ModulePass(ID) {
+  ir_generator::IRGenerator::module_filter_ = &FrameworkPass::AnyMayTrigger;
+  ir_generator::IRGenerator::function_filter_ = &FrameworkPass::AnyAnalyzes;
+}
 
 void FrameworkPass::getAnalysisUsage(llvm::AnalysisUsage &AU) const {
   AU.setPreservesAll();
   AU.addRequired<ir_generator::IRGenerator>();
 }
 
+std::vector<framework::StateManager> &FrameworkPass::StateManagers() {
+  if (!states_defined_) {
+    defineStates();
+    states_defined_ = true;
+  }
+  return manager_;
+}
+
+const std::set<const llvm::Function *> &FrameworkPass::AnalyzedFunctions(
+    llvm::Module &module) {
+  if (prescanned_module_ == &module) return analyzed_functions_;
+  prescanned_module_ = &module;
+  analyzed_functions_.clear();
+
+  std::set<std::string> callee_names;
+  StateTransitionManager::InstructionTriggers init_triggers, triggers;
+  for (auto &manager : StateManagers()) {
+    auto transition_manager = manager.TransitionManager();
+    auto names = transition_manager->CalleeNames();
+    callee_names.insert(names.begin(), names.end());
+    init_triggers |= transition_manager->UncalledTriggers(true);
+    triggers |= transition_manager->UncalledTriggers(false);
+  }
+
+  // Nothing can fire until some value leaves the init state
+  if (std::none_of(module.begin(), module.end(), [&](auto &function) {
+        return StateTransitionManager::HasLocalTrigger(function, callee_names,
+                                                       init_triggers);
+      }))
+    return analyzed_functions_;
+
+  analyzed_functions_ = StateTransitionManager::AnalyzedFunctions(
+      module, callee_names, triggers);
+  return analyzed_functions_;
+}
+
+bool FrameworkPass::mayTrigger(llvm::Module &module) {
+  return !AnalyzedFunctions(module).empty();
+}
+
+bool FrameworkPass::analyzes(llvm::Function &function) {
+  auto &functions = AnalyzedFunctions(*function.getParent());
+  return functions.find(&function) != functions.end();
+}
+
+bool FrameworkPass::AnyMayTrigger(llvm::Module &module) {
+  return std::any_of(passes.begin(), passes.end(),
+                     [&module](auto pass) { return pass->mayTrigger(module); });
+}
+
+bool FrameworkPass::AnyAnalyzes(llvm::Function &function) {
+  return std::any_of(
+      passes.begin(), passes.end(),
+      [&function](auto pass) { return pass->analyzes(function); });
+}
+
 /*** Main Modular ***/
 bool FrameworkPass::runOnModule(llvm::Module &M) {
+  if (!mayTrigger(M)) return false;
+
   std::chrono::system_clock::time_point start, end;
   LoggingServer server;
 
   start = std::chrono::system_clock::now();
-  defineStates();
 
   // Create analyzers and spawn threads
   std::vector<AnalyzerInfo> analyzers;
-  for (framework::StateManager &manager : manager_) {
+  for (framework::StateManager &manager : StateManagers()) {
     LoggingClient *client = new LoggingClient();
     AnalyzerInfo info =
         AnalyzerInfo(new framework::Analyzer(M, manager, *client));
@@ -104,17 +196,30 @@ bool FrameworkPass::runOnModule(llvm::Module &M) {
     server.addClient(client);
   }
 
-  for (auto analyzer = analyzers.begin() + 1; analyzer != analyzers.end();
-       analyzer++) {
-    analyzer->start_analyzer_process();
-  }
+  if (Fused && Threads)
+    llvm::errs() << "warning: -fused analyzes every state manager on one "
+                    "thread, ignoring -analyzer-threads\n";
+
+  if (Fused) {
+    FusedAnalyzer::Analyzers fused_analyzers;
+    for (auto &info : analyzers)
+      fused_analyzers.push_back(info.inner_analyzer);
+    FusedAnalyzer(M, fused_analyzers).analyze();
+  } else if (Threads) {
+    runAnalyzerThreads(analyzers, Threads);
+  } else {
+    for (auto analyzer = analyzers.begin() + 1; analyzer != analyzers.end();
+         analyzer++) {
+      analyzer->start_analyzer_process();
+    }
 
-  // Start the first process here
-  analyzers.begin()->run_analyzer();
+    // Start the first process here
+    analyzers.begin()->run_analyzer();
 
-  // Wait until the processes are done
-  for (int i = 0; !Async && i < analyzers.size() - 1; i++) {
-    wait(nullptr);
+    // Wait until the processes are done
+    for (size_t i = 1; !Async && i < analyzers.size(); i++) {
+      wait(nullptr);
+    }
   }
 
   end = std::chrono::system_clock::now();
@@ -126,6 +231,16 @@ bool FrameworkPass::runOnModule(llvm::Module &M) {
                                                                           start)
                         .count()
                  << "\n";
+
+    // Only the lookups of this process are counted
+    auto &converter = Converter::GetInstance();
+    llvm::errs() << "[Managed Values] (" << M.getName() << ") lookups "
+                 << converter.Lookups() << " hits " << converter.Hits() << "\n";
+
+    llvm::errs() << "[Framework IR] (" << M.getName() << ") converted "
+                 << ir_generator::IRGenerator::ConvertedFunctions()
+                 << " functions, skipped "
+                 << ir_generator::IRGenerator::SkippedFunctions() << "\n";
   }
 
   return false;
@@ -48,154 +48,251 @@
 namespace framework {
 FunctionInformation::FunctionInformation(
     std::shared_ptr<framework::Function> function, AnalysisStat stat)
-    : framework_function_(function), stat_(stat) {}
+    : framework_function_(function), stat_(stat) {
+  auto size = function ? function->OrderedBasicBlocks().size() : 0;
+  basic_block_info_.resize(size);
+  prev_basic_block_info_.resize(size);
+  change_counts_.resize(size);
+  merged_states_.resize(size);
+}
 
 void FunctionInformation::setAnalysisStat(
     FunctionInformation::AnalysisStat stat) {
+  // Callers analyzed on other threads query the values of an analyzed
+  // function, so its index must be complete before it is published
+  if (stat == ANALYZED) value_collection_.buildIndex();
   stat_ = stat;
 }
 
 void FunctionInformation::setAnayzingBasicBlock(
     std::shared_ptr<framework::BasicBlock> basic_block) {
   current_basicblock_ = basic_block;
+  current_block_index_ = blockIndex(basic_block);
 }
 
-std::shared_ptr<BasicBlockInformation>
+const std::shared_ptr<BasicBlockInformation>&
 FunctionInformation::getCurrentBasicBlockInformation() {
-  return basic_block_info_[current_basicblock_];
+  static const std::shared_ptr<BasicBlockInformation> kNoInformation;
+  if (current_block_index_ < 0) return kNoInformation;
+  return basic_block_info_[current_block_index_];
+}
+
+long FunctionInformation::blockIndex(
+    const std::shared_ptr<framework::BasicBlock>& basic_block) {
+  if (!basic_block || basic_block->Id() == framework::BasicBlock::kNoId)
+    return -1;
+
+  // Blocks created after this information (e.g. of a function generated
+  // later) grow the vectors
+  size_t index = basic_block->Id();
+  if (index >= basic_block_info_.size()) {
+    basic_block_info_.resize(index + 1);
+    prev_basic_block_info_.resize(index + 1);
+    change_counts_.resize(index + 1);
+    merged_states_.resize(index + 1);
+  }
+  return index;
 }
 
 std::shared_ptr<BasicBlockInformation>
 FunctionInformation::createBasicBlockInfo(
     std::shared_ptr<framework::BasicBlock> basic_block,
-    const std::set<State>& states) {
-  int time_to_live = BasicBlockInformation::kMaxTimeToLive;
+    std::shared_ptr<const std::set<State>> states,
+    const CustomMergeFunction& custom_merge) {
+  auto index = blockIndex(basic_block);
+  if (index < 0) return nullptr;
 
-  if (basicBlockInfoExists(basic_block)) {
-    prev_basic_block_info_[basic_block] = basic_block_info_[basic_block];
-    time_to_live = prev_basic_block_info_[basic_block]->TimeToLive() - 1;
-  }
+  auto prev_info = basic_block_info_[index];
+  if (prev_info) prev_basic_block_info_[index] = prev_info;
 
-  auto current_block_info = basic_block_info_[basic_block] =
+  auto current_block_info = basic_block_info_[index] =
       std::make_shared<BasicBlockInformation>(basic_block, states);
 
-  current_block_info->setTimeToLive(time_to_live);
-
   if (basic_block->isCleanupBlock()) return current_block_info;
 
+  auto& merged = merged_states_[index];
+  std::vector<EdgeStates*> sources;
+  std::set<std::shared_ptr<framework::Value>> changed_values;
+
   bool return_value_assigned = !current_block_info->ReturnValues().empty();
-  for (auto pred_reference : basic_block->Predecessors()) {
-    if (auto preds = pred_reference.lock()) {
-      if (!basicBlockInfoExists(preds)) {
+  for (auto& preds : basic_block->Predecessors()) {
+    if (!basicBlockInfoExists(preds)) {
+      current_block_info->setPartialStates(true);
+      continue;
+    }
+    auto passthrough_blocks =
+        std::vector<std::shared_ptr<framework::BasicBlock>>();
+
+    auto weak_blocks = preds->getPassthroughBlock(basic_block);
+    std::transform(weak_blocks.begin(), weak_blocks.end(),
+                   std::back_inserter(passthrough_blocks),
+                   [](const std::weak_ptr<framework::BasicBlock> block) {
+                     return block.lock();
+                   });
+    if (!passthrough_blocks.size()) passthrough_blocks.push_back(preds);
+
+    for (auto block : passthrough_blocks) {
+      // A self loop carries the states of the previous visit
+      auto pred_block_info =
+          block == basic_block ? prev_info : getBasicBlockInformation(block);
+      if (!pred_block_info) {
         current_block_info->setPartialStates(true);
         continue;
       }
-      auto passthrough_blocks =
-          std::vector<std::shared_ptr<framework::BasicBlock>>();
-
-      auto weak_blocks = preds->getPassthroughBlock(basic_block);
-      std::transform(weak_blocks.begin(), weak_blocks.end(),
-                     std::back_inserter(passthrough_blocks),
-                     [](const std::weak_ptr<framework::BasicBlock> block) {
-                       return block.lock();
-                     });
-      if (!passthrough_blocks.size()) passthrough_blocks.push_back(preds);
-
-      for (auto block : passthrough_blocks) {
-        if (!basicBlockInfoExists(block)) {
-          current_block_info->setPartialStates(true);
-          continue;
-        }
 
-        auto pred_block_info = basic_block_info_[block];
-        if (pred_block_info->PartialStates()) {
-          if (block->Line() < basic_block->Line())
-            current_block_info->setPartialStates(true);
-          else if (pred_block_info->TimeToLive() > 0)
-            current_block_info->setPartialStates(true);
-          continue;
-        }
+      // Predecessors with partial states are merged as well. Once their
+      // states are complete, the worklist analyzes this block again.
+      if (pred_block_info->PartialStates())
+        current_block_info->setPartialStates(true);
 
-        // TODO: Fix this rough check of error code propagation
-        BasicBlockInformation::BlockStatus status =
-            pred_block_info->getBlockStatus();
-        const auto& branch_inst =
-            pred_block_info->BasicBlock()->getBranchInst();
-        if (branch_inst && branch_inst->Condition() &&
-            branch_inst->returnValueOperandExists()) {
-          status = BasicBlockInformation::ERROR;
-          if (auto condition =
-                  shared_dyn_cast<CompareInst>(branch_inst->Condition())) {
-            switch (condition->GetPredicate()) {
-              case llvm::CmpInst::Predicate::ICMP_EQ:
-              case llvm::CmpInst::Predicate::ICMP_SGT:
-                status = BasicBlockInformation::SUCCESS;
-              case llvm::CmpInst::Predicate::ICMP_NE:
-              case llvm::CmpInst::Predicate::ICMP_SLT:
-                status = BasicBlockInformation::ERROR;
-              default:
-                break;
-            }
+      // TODO: Fix this rough check of error code propagation
+      BasicBlockInformation::BlockStatus status =
+          pred_block_info->getBlockStatus();
+      const auto& branch_inst =
+          pred_block_info->BasicBlock()->getBranchInst();
+      if (branch_inst && branch_inst->Condition() &&
+          branch_inst->returnValueOperandExists()) {
+        status = BasicBlockInformation::ERROR;
+        if (auto condition =
+                shared_dyn_cast<CompareInst>(branch_inst->Condition())) {
+          switch (condition->GetPredicate()) {
+            case llvm::CmpInst::Predicate::ICMP_EQ:
+            case llvm::CmpInst::Predicate::ICMP_SGT:
+              status = BasicBlockInformation::SUCCESS;
+              // Falls through as it always has, so every compared return
+              // value still marks an error block (see the TODO above)
+              [[fallthrough]];
+            case llvm::CmpInst::Predicate::ICMP_NE:
+            case llvm::CmpInst::Predicate::ICMP_SLT:
+              status = BasicBlockInformation::ERROR;
+            default:
+              break;
           }
         }
-        current_block_info->setBlockStatus(status);
+      }
+      current_block_info->setBlockStatus(status);
 
+      // Only recompute the states of edges whose source was analyzed
+      // again, and remember the values that differ from the last visit
+      auto& edge = merged.edges[block->Id()];
+      if (edge.source.lock() != pred_block_info) {
         auto pred_value_states =
             pred_block_info->ValueStatesForSuccessor(basic_block);
-        for (auto val_states : pred_value_states.first.ValueStates()) {
-          auto& value = val_states.first;
-          if (!current_block_info->ValueStates().valueExists(value)) {
-            current_block_info->ValueStates().setValueState(
-                value, pred_value_states.first.getTransitionLog(value));
-            continue;
-          }
-
-          auto pred_state = pred_value_states.first.getState(value);
-          auto curr_state = current_block_info->ValueStates().getState(value);
-          if (pred_state < curr_state) {
-            current_block_info->ValueStates().setValueState(
-                value, pred_value_states.first.getTransitionLog(value));
-          }
-
-          /* if (curr_state < pred_state) { */
-          /*   current_block_info->ValueStates().setValueState( */
-          /*       value, pred_value_states.first.getTransitionLog(value)); */
-          /* } */
+        const auto& prev_states = edge.value_states.ValueStates();
+        const auto& new_states = pred_value_states.first.ValueStates();
+        for (const auto& [value, logs] : new_states) {
+          auto prev_logs = prev_states.lookup(value);
+          if (!prev_logs || !(*prev_logs == logs))
+            changed_values.insert(value);
         }
-
-        /* if (!basic_block->Instructions().empty()) */
-        /*   generateWarning(basic_block->Instructions().front().get(), */
-        /*                   "Target"); */
-        if (!return_value_assigned) {
-          current_block_info->addReturnValues(
-              pred_block_info->ReturnCodeForSuccessor(basic_block));
+        for (const auto& value_states : prev_states) {
+          if (!new_states.contains(value_states.first))
+            changed_values.insert(value_states.first);
         }
-
-        current_block_info->getArgValueStates().addArgValueState(
-            pred_value_states.second);
-
-        /* generateWarning(pred_block_info->BasicBlock().get() ,"---"); */
-        /* for (auto ret_val : current_block_info->ReturnValues()) { */
-        /*   if (auto cv = framework::shared_dyn_cast<ConstValue>(ret_val)) { */
-        /*     generateWarning(current_block_info->BasicBlock().get(),
-         * std::to_string(cv->getConstValue())); */
-        /*   } */
-        /* } */
-        /* generateWarning("---"); */
-
-        // TODO: Experimental: Enable when in use
-        /* current_block_info->getAliasValues().addAlias( */
-        /*     pred_block_info->getAliasValues()); */
+        edge = {pred_block_info, pred_value_states.first,
+                pred_value_states.second};
+      }
+      sources.push_back(&edge);
+
+      /* if (!basic_block->Instructions().empty()) */
+      /*   generateWarning(basic_block->Instructions().front().get(), */
+      /*                   "Target"); */
+      if (!return_value_assigned) {
+        current_block_info->addReturnValues(
+            pred_block_info->ReturnCodeForSuccessor(basic_block));
       }
+
+      current_block_info->getArgValueStates().addArgValueState(
+          edge.arg_value_states);
+
+      /* generateWarning(pred_block_info->BasicBlock().get() ,"---"); */
+      /* for (auto ret_val : current_block_info->ReturnValues()) { */
+      /*   if (auto cv = framework::shared_dyn_cast<ConstValue>(ret_val)) { */
+      /*     generateWarning(current_block_info->BasicBlock().get(),
+       * std::to_string(cv->getConstValue())); */
+      /*   } */
+      /* } */
+      /* generateWarning("---"); */
+
+      // TODO: Experimental: Enable when in use
+      /* current_block_info->getAliasValues().addAlias( */
+      /*     pred_block_info->getAliasValues()); */
     }
   }
 
+  mergeValueStates(merged, sources, changed_values, custom_merge,
+                   change_counts_[index] >= kWidenAfterChanges);
+  current_block_info->ValueStates() = merged.value_states;
+
   if (current_block_info->getBlockStatus() == BasicBlockInformation::NONE)
     current_block_info->setBlockStatus(BasicBlockInformation::NUTRAL);
 
   return current_block_info;
 }
 
+void FunctionInformation::mergeValueStates(
+    MergedStates& merged, const std::vector<EdgeStates*>& sources,
+    const std::set<std::shared_ptr<framework::Value>>& changed_values,
+    const CustomMergeFunction& custom_merge, bool widen) {
+  std::vector<const TransitionLogs*> candidates;
+  for (auto value : changed_values) {
+    // The first edge with the least state wins, as in a full merge over the
+    // predecessors
+    const TransitionLogs* merged_logs = nullptr;
+    candidates.clear();
+    for (auto edge : sources) {
+      auto logs = edge->value_states.ValueStates().lookup(value);
+      if (!logs) continue;
+      candidates.push_back(logs);
+      if (!merged_logs || logs->CurrentState() < merged_logs->CurrentState())
+        merged_logs = logs;
+    }
+
+    if (!merged_logs) {
+      merged.value_states.removeValue(value);
+      continue;
+    }
+
+    // Collapsing an already collapsed history gives the same logs, so a
+    // widened block converges once its states do
+    if (widen) {
+      auto logs = merged_logs->Collapsed();
+      merged.value_states.setValueState(value, logs);
+      continue;
+    }
+
+    bool joined = std::any_of(
+        candidates.begin(), candidates.end(), [&](const TransitionLogs* logs) {
+          return logs != merged_logs && !(*logs == *merged_logs);
+        });
+    if (!joined) {
+      merged.value_states.setValueState(
+          value, const_cast<TransitionLogs&>(*merged_logs));
+      continue;
+    }
+
+    // Edges disagree. STRICT keeps the whole history of the winning edge,
+    // FLEX only its reduced transition, so that the logs stay bounded.
+    TransitionLogs logs;
+    switch (merged_logs->CurrentState().MergeMethod()) {
+      case StateMergeMethod::FLEX:
+        logs = merged_logs->Collapsed();
+        break;
+      case StateMergeMethod::CUSTOM:
+        logs = custom_merge ? custom_merge(candidates) : *merged_logs;
+        break;
+      default:
+        logs = *merged_logs;
+        break;
+    }
+    if (logs.isDummy()) {
+      merged.value_states.removeValue(value);
+      continue;
+    }
+    merged.value_states.setValueState(value, logs);
+  }
+}
+
 void FunctionInformation::addValue(std::shared_ptr<Value> value) {
   value_collection_.add(value);
 }
@@ -204,30 +301,22 @@ void FunctionInformation::addValues(const ValueCollection& collection) {
   value_collection_.add(collection);
 }
 
-std::shared_ptr<BasicBlockInformation>
+const std::shared_ptr<BasicBlockInformation>&
 FunctionInformation::getBasicBlockInformation(
-    std::shared_ptr<framework::BasicBlock> basic_block) {
-  if (basicBlockInfoExists(basic_block)) return basic_block_info_[basic_block];
-  return nullptr;
-}
-
-std::shared_ptr<BasicBlockInformation>
-FunctionInformation::getBasicBlockPrevInformation(
-    std::shared_ptr<framework::BasicBlock> basic_block) {
-  if (basicBlockPrevInfoExists(basic_block))
-    return prev_basic_block_info_[basic_block];
-  return nullptr;
+    const std::shared_ptr<framework::BasicBlock>& basic_block) {
+  static const std::shared_ptr<BasicBlockInformation> kNoInformation;
+  if (!basicBlockInfoExists(basic_block)) return kNoInformation;
+  return basic_block_info_[basic_block->Id()];
 }
 
 bool FunctionInformation::basicBlockInfoExists(
-    std::shared_ptr<framework::BasicBlock> basic_block) {
-  return basic_block_info_.find(basic_block) != basic_block_info_.end();
-}
-
-bool FunctionInformation::basicBlockPrevInfoExists(
-    std::shared_ptr<framework::BasicBlock> basic_block) {
-  return prev_basic_block_info_.find(basic_block) !=
-         prev_basic_block_info_.end();
+    const std::shared_ptr<framework::BasicBlock>& basic_block) {
+  // IDs are only unique within a function, so also check the block itself
+  if (!basic_block || basic_block->Id() == framework::BasicBlock::kNoId ||
+      static_cast<size_t>(basic_block->Id()) >= basic_block_info_.size())
+    return false;
+  const auto& info = basic_block_info_[basic_block->Id()];
+  return info && info->BasicBlock() == basic_block;
 }
 
 const FunctionInformation::WeakBasicBlockSet&
@@ -237,21 +326,24 @@ FunctionInformation::getErrorBlocks(int64_t error_code) {
 
 const FunctionInformation::WeakBasicBlockSet&
 FunctionInformation::getSuccessBlock() {
-  return return_info_[kSuccessCode];
+  // Read by the callers, possibly on several threads, so nothing is inserted
+  static const WeakBasicBlockSet kNoBlocks;
+  auto success = return_info_.find(kSuccessCode);
+  if (success == return_info_.end()) return kNoBlocks;
+  return success->second;
 }
 
 bool FunctionInformation::basicBlockInfoChanged(
     std::shared_ptr<framework::BasicBlock> block) {
-  auto current_info = getBasicBlockInformation(block);
-  auto prev_info = getBasicBlockPrevInformation(block);
-  if (!current_info || !prev_info) return true;
-
-  if (current_info->PartialStates()) return true;
-
-  if (current_info->TimeToLive() <= 0) return false;
-
-  /* if (*current_info == *prev_info || !current_info->TimeToLive()) */
-  if (*current_info == *prev_info) return false;
+  const auto& current_info = getBasicBlockInformation(block);
+  if (!current_info) return true;
+
+  // The fingerprint only rules changes in, so equal ones are confirmed
+  const auto& prev_info = prev_basic_block_info_[block->Id()];
+  if (prev_info && current_info->Fingerprint() == prev_info->Fingerprint() &&
+      *current_info == *prev_info)
+    return false;
+  change_counts_[block->Id()]++;
   return true;
 }
 
@@ -272,6 +364,39 @@ void FunctionInformation::addReturnValueInfo(int64_t value,
   return_info_[value].insert(block_info.begin(), block_info.end());
 }
 
+bool FunctionInformation::sameSummary(FunctionInformation& info) {
+  auto non_empty = [](const std::map<int64_t, WeakBasicBlockSet>& return_info) {
+    return std::count_if(return_info.begin(), return_info.end(),
+                         [](const auto& ret) { return !ret.second.empty(); });
+  };
+  if (non_empty(return_info_) != non_empty(info.return_info_)) return false;
+
+  for (const auto& ret : return_info_) {
+    if (ret.second.empty()) continue;
+    auto other = info.return_info_.find(ret.first);
+    if (other == info.return_info_.end() ||
+        ret.second.size() != other->second.size())
+      return false;
+
+    for (auto block_ref : ret.second) {
+      if (other->second.find(block_ref) == other->second.end()) return false;
+      auto block = block_ref.lock();
+      if (!block) continue;
+
+      auto block_info = getBasicBlockInformation(block);
+      auto other_block_info = info.getBasicBlockInformation(block);
+      if (!block_info || !other_block_info) {
+        if (block_info != other_block_info) return false;
+        continue;
+      }
+      if (!(block_info->getArgValueStates() ==
+            other_block_info->getArgValueStates()))
+        return false;
+    }
+  }
+  return true;
+}
+
 bool FunctionInformation::existsInRefcountFunctions(
     std::shared_ptr<framework::Function> function) {
   return std::find(called_refcount_functions_.begin(),
@@ -0,0 +1,385 @@
+#include "frontend/FusedAnalyzer.hpp"
+
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+
+// include STL
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <stack>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/Casting.hpp"
+#include "core/Instructions.hpp"
+#include "core/Utils.hpp"
+#include "framework_ir/IRGenerator.hpp"
+#include "frontend/WorkStealingPool.hpp"
+
+static llvm::cl::opt<unsigned> SCCThreads(
+    "scc-threads",
+    llvm::cl::desc("Analyze independent functions on N threads (0 uses every "
+                   "core). Each analyzed module starts its own threads."),
+    llvm::cl::init(1));
+
+namespace framework {
+FusedAnalyzer::FusedAnalyzer(llvm::Module &llvm_module, Analyzers analyzers)
+    : llvm_module_(llvm_module), analyzers_(analyzers) {}
+
+void FusedAnalyzer::analyze() {
+  // The framework IR is only read here, so that analyzers on different threads
+  // can share it
+  auto &framework_ir = ir_generator::IRGenerator::framework_ir_;
+  auto module_ir = framework_ir.find(&llvm_module_);
+  if (module_ir != framework_ir.end()) {
+    auto sccs = BottomUpSCCs(module_ir->second);
+    unsigned thread_num =
+        SCCThreads ? SCCThreads : std::thread::hardware_concurrency();
+    if (thread_num > 1 && sccs.size() > 1) {
+      analyzeSCCsInParallel(sccs, module_ir->second, thread_num);
+    } else {
+      for (auto& scc : sccs) analyzeSCC(scc);
+    }
+  }
+
+  for (auto analyzer : analyzers_) analyzer->flush();
+}
+
+void FusedAnalyzer::analyzeSCCsInParallel(const std::vector<FunctionSCC>& sccs,
+                                          const FunctionSet& functions,
+                                          unsigned thread_num) {
+  // An SCC is ready once the SCCs of all its callees are analyzed
+  std::map<std::shared_ptr<framework::Function>, size_t> scc_index;
+  for (size_t i = 0; i < sccs.size(); i++) {
+    for (auto& function : sccs[i]) scc_index[function] = i;
+  }
+
+  auto call_graph = CallGraph(functions);
+  std::vector<std::vector<size_t>> callers(sccs.size());
+  std::vector<std::atomic<size_t>> waiting(sccs.size());
+  for (size_t i = 0; i < sccs.size(); i++) {
+    std::set<size_t> callee_sccs;
+    for (auto& function : sccs[i]) {
+      for (auto& callee : call_graph[function]) {
+        if (scc_index[callee] != i) callee_sccs.insert(scc_index[callee]);
+      }
+    }
+    waiting[i] = callee_sccs.size();
+    for (auto callee : callee_sccs) callers[callee].push_back(i);
+  }
+
+  // Each worker thread analyzes with its own analyzers, which share the
+  // function information with the analyzers they were created from. Their
+  // logs are collected per SCC.
+  WorkStealingPool pool(std::min<size_t>(thread_num, sccs.size()));
+  std::vector<std::vector<std::unique_ptr<LoggingClient>>> clients;
+  std::vector<std::vector<std::unique_ptr<Analyzer>>> worker_analyzers;
+  std::vector<std::unique_ptr<FusedAnalyzer>> workers;
+  for (size_t i = 0; i < pool.WorkerNum(); i++) {
+    Analyzers analyzers;
+    clients.emplace_back();
+    worker_analyzers.emplace_back();
+    for (auto analyzer : analyzers_) {
+      clients.back().push_back(std::make_unique<LoggingClient>(false));
+      worker_analyzers.back().push_back(
+          analyzer->createWorker(*clients.back().back()));
+      analyzers.push_back(worker_analyzers.back().back().get());
+    }
+    workers.push_back(std::make_unique<FusedAnalyzer>(llvm_module_, analyzers));
+  }
+
+  std::vector<std::vector<std::string>> logs(sccs.size());
+  std::function<void(size_t, size_t)> analyze_scc = [&](size_t index,
+                                                        size_t worker) {
+    workers[worker]->analyzeSCC(sccs[index]);
+    for (auto& client : clients[worker])
+      logs[index].push_back(client->extract(0));
+
+    for (auto caller : callers[index]) {
+      if (--waiting[caller] == 0) {
+        pool.push(worker, [&analyze_scc, caller](size_t worker) {
+          analyze_scc(caller, worker);
+        });
+      }
+    }
+  };
+
+  for (size_t i = 0; i < sccs.size(); i++) {
+    if (waiting[i]) continue;
+    pool.push(i, [&analyze_scc, i](size_t worker) { analyze_scc(i, worker); });
+  }
+  pool.run();
+
+  // Log in the bottom-up order, as if the SCCs were analyzed one by one
+  for (auto& scc_logs : logs) {
+    for (size_t i = 0; i < scc_logs.size(); i++)
+      analyzers_[i]->LogClient().log(scc_logs[i]);
+  }
+}
+
+void FusedAnalyzer::analyzeSCC(const FunctionSCC &scc) {
+  current_scc_ = FunctionSet(scc.begin(), scc.end());
+
+  // Members of an SCC of more than one function call each other
+  bool recursive = scc.size() > 1;
+  for (auto function : scc) {
+    for (auto block : function->OrderedBasicBlocks()) {
+      for (auto inst : block->Instructions()) {
+        auto call_inst = shared_dyn_cast<framework::CallInst>(inst);
+        if (call_inst && call_inst->CalledFunction() == function)
+          recursive = true;
+      }
+    }
+  }
+
+  if (!recursive) {
+    analyzeFunction(scc.front(), analyzers_);
+    current_scc_.clear();
+    return;
+  }
+
+  // Iterate until the results visible to the callers stop changing. Only the
+  // logs of the last iteration are kept.
+  for (int iteration = 0; iteration < kMaxSCCIteration; iteration++) {
+    std::vector<size_t> log_sizes;
+    std::vector<std::shared_ptr<FunctionInformation>> prev_info;
+    for (auto analyzer : analyzers_) {
+      log_sizes.push_back(analyzer->LogClient().Size());
+      for (auto function : scc)
+        prev_info.push_back(analyzer->getFunctionInformation(function));
+    }
+
+    for (auto function : scc) analyzeFunction(function, analyzers_, true);
+
+    bool converged = true;
+    auto prev = prev_info.begin();
+    for (auto analyzer : analyzers_) {
+      for (auto function : scc) {
+        // Functions the analyzer skipped have nothing to converge
+        auto current = analyzer->getFunctionInformation(function);
+        if (current && (!*prev || !(*prev)->sameSummary(*current)))
+          converged = false;
+        prev++;
+      }
+    }
+    if (converged) break;
+    if (iteration == kMaxSCCIteration - 1) {
+      std::string functions;
+      for (auto function : scc) functions += " " + function->Name();
+      llvm::errs() << "[WARNING] Recursive functions" + functions +
+                          " did not converge after " +
+                          std::to_string(kMaxSCCIteration) + " iterations\n";
+      break;
+    }
+
+    for (size_t i = 0; i < analyzers_.size(); i++)
+      analyzers_[i]->LogClient().truncate(log_sizes[i]);
+  }
+  current_scc_.clear();
+}
+
+void FusedAnalyzer::analyzeFunction(
+    std::shared_ptr<framework::Function> function, const Analyzers &analyzers,
+    bool reanalyze) {
+  Analyzers active;
+  for (auto analyzer : analyzers) {
+    if (analyzer->beginFunction(function, reanalyze))
+      active.push_back(analyzer);
+  }
+  if (active.empty()) return;
+
+  const auto &blocks = function->ReversePostOrderBlocks();
+  std::map<std::shared_ptr<framework::BasicBlock>, size_t> block_index;
+  for (size_t i = 0; i < blocks.size(); i++) block_index[blocks[i]] = i;
+
+  // Worklist keyed by the reverse post order index, so that a block is
+  // analyzed after its forward predecessors. Each block is queued along with
+  // the analyzers that still have to analyze it.
+  std::map<size_t, Analyzers> worklist;
+  for (size_t i = 0; i < blocks.size(); i++) worklist[i] = active;
+
+  std::map<std::pair<framework::Analyzer *, size_t>, int> visits;
+  // Reports of the last visit of each block
+  std::map<std::pair<framework::Analyzer *, size_t>, std::string> reports;
+  auto enqueue = [&](framework::Analyzer *analyzer,
+                     std::shared_ptr<framework::BasicBlock> block) {
+    auto index = block_index.find(block);
+    if (index == block_index.end()) return;
+    auto &queued = worklist[index->second];
+    if (std::find(queued.begin(), queued.end(), analyzer) == queued.end())
+      queued.push_back(analyzer);
+  };
+
+  while (!worklist.empty()) {
+    auto [index, block_analyzers] = *worklist.begin();
+    worklist.erase(worklist.begin());
+    auto block = blocks[index];
+
+    std::vector<size_t> known_values;
+    for (auto analyzer : block_analyzers)
+      known_values.push_back(KnownValues(analyzer));
+
+    analyzeBasicBlock(block, block_analyzers);
+
+    for (size_t i = 0; i < block_analyzers.size(); i++) {
+      auto analyzer = block_analyzers[i];
+      // Values reported here are terminated before the successors merge them.
+      // The reports are kept aside, as a later visit replaces them.
+      auto &log = analyzer->LogClient();
+      size_t log_size = log.Size();
+      analyzer->reportBasicBlock(block);
+      reports[{analyzer, index}] = log.extract(log_size);
+
+      // Values found on this visit may be related to the values changed
+      // earlier in the block, so the block is analyzed again with them
+      bool found_values = KnownValues(analyzer) != known_values[i];
+      bool changed = analyzer->basicBlockChanged(block);
+      if (!changed && !found_values) continue;
+      if (++visits[{analyzer, index}] > kMaxBlockVisit) {
+        generateWarning("[WARNING] Block " + block->Name() + " of " +
+                        function->Name() + " did not converge");
+        continue;
+      }
+
+      if (found_values) enqueue(analyzer, block);
+      if (!changed) continue;
+      for (auto& succ : block->Successors()) {
+        enqueue(analyzer, succ);
+        // Cleanup blocks pass the states of this block through to their
+        // successors
+        if (!succ->isCleanupBlock()) continue;
+        for (auto& next : succ->Successors()) enqueue(analyzer, next);
+      }
+    }
+  }
+
+  // Report the converged states in reverse post order
+  for (size_t i = 0; i < blocks.size(); i++) {
+    for (auto analyzer : active) {
+      auto report = reports.find({analyzer, i});
+      if (report != reports.end()) analyzer->LogClient().log(report->second);
+    }
+  }
+
+  for (auto analyzer : active) analyzer->endFunction(function);
+}
+
+void FusedAnalyzer::analyzeBasicBlock(
+    std::shared_ptr<framework::BasicBlock> block, const Analyzers &analyzers) {
+  for (auto analyzer : analyzers) analyzer->beginBasicBlock(block);
+
+  for (auto inst : block->Instructions()) {
+    Analyzers callers;
+    std::shared_ptr<framework::Function> called_func;
+    for (auto analyzer : analyzers) {
+      if (auto function = analyzer->analyzeInstruction(inst)) {
+        called_func = function;
+        callers.push_back(analyzer);
+      }
+    }
+    if (callers.empty()) continue;
+
+    if (current_scc_.find(called_func) == current_scc_.end())
+      analyzeFunction(called_func, callers);
+    for (auto analyzer : callers) analyzer->resumeCallInst(called_func, inst);
+  }
+}
+
+size_t FusedAnalyzer::KnownValues(framework::Analyzer *analyzer) {
+  return analyzer->currentFunctionInformation()->GetValueCollection().size();
+}
+
+std::map<std::shared_ptr<framework::Function>, FusedAnalyzer::FunctionSCC>
+FusedAnalyzer::CallGraph(const FunctionSet &functions) {
+  std::map<std::shared_ptr<framework::Function>, FunctionSCC> callees;
+  for (auto function : functions) {
+    FunctionSet called;
+    for (auto block : function->OrderedBasicBlocks()) {
+      for (auto inst : block->Instructions()) {
+        auto call_inst = shared_dyn_cast<framework::CallInst>(inst);
+        if (!call_inst || !call_inst->CalledFunction()) continue;
+        if (functions.find(call_inst->CalledFunction()) == functions.end())
+          continue;
+        if (called.insert(call_inst->CalledFunction()).second)
+          callees[function].push_back(call_inst->CalledFunction());
+      }
+    }
+  }
+  return callees;
+}
+
+std::vector<FusedAnalyzer::FunctionSCC> FusedAnalyzer::BottomUpSCCs(
+    const FunctionSet &functions) {
+  auto callees = CallGraph(functions);
+
+  // Tarjan's algorithm with an explicit stack, so that long call chains do not
+  // overflow the native stack. SCCs are found callees first.
+  struct NodeInfo {
+    int index;
+    int low_link;
+    bool on_stack;
+  };
+  std::map<std::shared_ptr<framework::Function>, NodeInfo> nodes;
+  std::vector<std::shared_ptr<framework::Function>> scc_stack;
+  std::vector<FunctionSCC> sccs;
+  int index = 0;
+
+  for (auto root : functions) {
+    if (nodes.find(root) != nodes.end()) continue;
+
+    // Pair of the function and the position of the next callee to visit
+    std::stack<std::pair<std::shared_ptr<framework::Function>, size_t>> work;
+    work.emplace(root, 0);
+    nodes[root] = NodeInfo{index, index, true};
+    index++;
+    scc_stack.push_back(root);
+
+    while (!work.empty()) {
+      auto &[function, next] = work.top();
+      auto &function_callees = callees[function];
+
+      if (next < function_callees.size()) {
+        auto callee = function_callees[next++];
+        auto callee_node = nodes.find(callee);
+        if (callee_node == nodes.end()) {
+          nodes[callee] = NodeInfo{index, index, true};
+          index++;
+          scc_stack.push_back(callee);
+          work.emplace(callee, 0);
+        } else if (callee_node->second.on_stack) {
+          nodes[function].low_link =
+              std::min(nodes[function].low_link, callee_node->second.index);
+        }
+        continue;
+      }
+
+      auto finished = function;
+      work.pop();
+      if (!work.empty()) {
+        auto &caller = nodes[work.top().first];
+        caller.low_link = std::min(caller.low_link, nodes[finished].low_link);
+      }
+
+      if (nodes[finished].low_link != nodes[finished].index) continue;
+
+      FunctionSCC scc;
+      std::shared_ptr<framework::Function> member;
+      do {
+        member = scc_stack.back();
+        scc_stack.pop_back();
+        nodes[member].on_stack = false;
+        scc.push_back(member);
+      } while (member != finished);
+      sccs.push_back(scc);
+    }
+  }
+  return sccs;
+}
+}  // namespace framework
@@ -10,10 +10,12 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/Value.h"
 #include "llvm/IR/ValueSymbolTable.h"
@@ -27,10 +29,12 @@
 #include <algorithm>
 #include <cassert>
 #include <ctime>
+#include <deque>
 #include <iostream>
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <set>
 #include <stack>
@@ -44,70 +48,95 @@
 namespace framework {
 
 /* State Class */
+State::State() : ID_(0) {
+  static const Properties* default_properties =
+      Intern(Properties{"", NORMAL, STRICT, IMMEDIATE, NONE, true});
+  properties_ = default_properties;
+}
+
 State::State(int ID, std::string name, StateType type, StateMergeMethod method,
              bool early_notification, TriggerConstraint constraint,
              BugNotificationTiming timing)
     : ID_(ID),
-      name_(name),
-      type_(type),
-      method_(method),
-      early_notification_(early_notification),
-      trigger_constraint_(constraint),
-      timing_(timing){};
+      properties_(Intern(Properties{name, type, method, timing, constraint,
+                                    early_notification})) {}
 
 State::State(int ID, StateArgs& args)
     : ID_(ID),
-      name_(args.name_),
-      type_(args.type_),
-      method_(args.method_),
-      early_notification_(args.early_notification_),
-      trigger_constraint_(args.trigger_constraint_),
-      timing_(args.timing_){};
+      properties_(Intern(Properties{args.name_, args.type_, args.method_,
+                                    args.timing_, args.trigger_constraint_,
+                                    args.early_notification_})) {}
+
+State::State(int ID, StateArgs& args, int count_num,
+             const std::set<int>& bug_counts)
+    : ID_(ID) {
+  Properties properties{args.name_,   args.type_,
+                        args.method_, args.timing_,
+                        args.trigger_constraint_,
+                        args.early_notification_};
+  for (int count = 0; count < count_num; count++) {
+    properties.count_names.push_back(args.name_ + " " + std::to_string(count));
+    properties.bug_counts.push_back(bug_counts.count(count));
+  }
+  properties_ = Intern(properties);
+}
 
-State::State(const State& state)
-    : ID_(state.ID_),
-      name_(state.name_),
-      type_(state.type_),
-      method_(state.method_),
-      early_notification_(state.early_notification_),
-      trigger_constraint_(state.trigger_constraint_),
-      timing_(state.timing_){};
+State State::WithCount(int count) const {
+  assert(count >= 0 && count < CountNum());
+  State state = *this;
+  state.count_ = count;
+  return state;
+}
 
-void State::addTransition(State& state, TransitionRule& rule) {
-  transitions_.push_back(std::pair<State, TransitionRule>(state, rule));
+bool State::Properties::operator==(const Properties& properties) const {
+  return name == properties.name && type == properties.type &&
+         method == properties.method && timing == properties.timing &&
+         trigger_constraint == properties.trigger_constraint &&
+         early_notification == properties.early_notification &&
+         count_names == properties.count_names &&
+         bug_counts == properties.bug_counts;
 }
 
-bool State::operator<(const State& state) const { return ID_ < state.ID_; }
+const State::Properties* State::Intern(const Properties& properties) {
+  // Only a few states are defined per detector, so a linear search is enough
+  static std::mutex mutex;
+  static std::deque<Properties> interned;
 
-bool State::operator<(const StateArgs& args) const {
-  if (type_ == args.type_) return name_ < args.name_;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = std::find(interned.begin(), interned.end(), properties);
+  if (found != interned.end()) return &*found;
+  return &interned.emplace_back(properties);
+}
 
-  return type_ < args.type_;
+// Bug states come last, as their IDs do for states other than counters
+bool State::operator<(const State& state) const {
+  if (isBugState() != state.isBugState()) return state.isBugState();
+  if (ID_ != state.ID_) return ID_ < state.ID_;
+  return count_ < state.count_;
 }
 
-bool State::operator==(const State& state) const { return ID_ == state.ID_; }
-bool State::operator!=(const State& state) const { return ID_ != state.ID_; }
+bool State::operator<(const StateArgs& args) const {
+  if (properties_->type == args.type_) return properties_->name < args.name_;
 
-bool State::operator==(const std::string& name) const { return name == name_; }
-bool State::operator==(const StateArgs& args) const {
-  return name_ == args.name_ && type_ == args.type_;
+  return properties_->type < args.type_;
 }
 
-State& State::operator=(const State& state) {
-  ID_ = state.ID_;
-  name_ = state.name_;
-  type_ = state.type_;
-  method_ = state.method_;
-  timing_ = state.timing_;
-  trigger_constraint_ = state.trigger_constraint_;
-  early_notification_ = state.early_notification_;
-  return *this;
+bool State::operator==(const State& state) const {
+  return ID_ == state.ID_ && count_ == state.count_;
+}
+bool State::operator!=(const State& state) const { return !(*this == state); }
+
+bool State::operator==(const std::string& name) const {
+  return name == properties_->name;
+}
+bool State::operator==(const StateArgs& args) const {
+  return properties_->name == args.name_ && properties_->type == args.type_;
 }
 
 StateManager::StateManager()
-    : early_state_transition_(false),
+    : propagation_constraint_(nullptr),
       init_state_(nullptr),
-      propagation_constraint_(nullptr) {
+      early_state_transition_(false) {
   StateArgs init_args =
       framework::StateArgs("init", framework::StateType::INIT);
   init_state_ = &createState(init_args);
@@ -121,6 +150,7 @@ StateManager::StateManager(std::set<State> states)
   StateArgs init_args =
       framework::StateArgs("init", framework::StateType::INIT);
   init_state_ = &createState(init_args);
+  shared_states_ = std::make_shared<const std::set<State>>(states_);
 
   transition_manager_ = std::make_shared<StateTransitionManager>();
 }
@@ -134,6 +164,7 @@ State& StateManager::createState(StateArgs& args) {
                              : states_.size();
   State new_state = State(id, args);
   auto inserted_state = states_.insert(new_state);
+  shared_states_ = std::make_shared<const std::set<State>>(states_);
   return const_cast<State&>(*inserted_state.first);
 }
 
@@ -154,6 +185,27 @@ std::set<State> StateManager::createStates(std::vector<StateArgs>& states) {
   return new_states;
 }
 
+State& StateManager::createCounterState(State& base, StateArgs& args,
+                                        int size, TransitionRule& inc,
+                                        TransitionRule& dec,
+                                        const std::set<int>& bug_counts) {
+  auto searched_states = std::find(states_.begin(), states_.end(), args);
+  if (searched_states != states_.end())
+    return const_cast<State&>(*searched_states);
+
+  State counter = State(states_.size(), args, size, bug_counts);
+  auto inserted_state = states_.insert(counter);
+  shared_states_ = std::make_shared<const std::set<State>>(states_);
+
+  auto enter = transition_manager_->createTransition(base, counter);
+  transition_manager_->addTransitionRule(enter, inc);
+  auto increment = Transition::Counting(counter, 1, base);
+  transition_manager_->addTransitionRule(increment, inc);
+  auto decrement = Transition::Counting(counter, -1, base);
+  transition_manager_->addTransitionRule(decrement, dec);
+  return const_cast<State&>(*inserted_state.first);
+}
+
 State& StateManager::getByName(const std::string& name) {
   auto state =
       std::find_if(states_.begin(), states_.end(),
@@ -181,7 +233,10 @@ const std::set<State> StateManager::getBugStates() {
   if (!bug_states_.empty()) return bug_states_;
 
   for (auto& state : states_) {
-    if (state.isBugState()) bug_states_.insert(state);
+    for (int count = 0; count < state.CountNum(); count++) {
+      State counted = state.isCounter() ? state.WithCount(count) : state;
+      if (counted.isBugState()) bug_states_.insert(counted);
+    }
   }
   return bug_states_;
 }
@@ -201,7 +256,26 @@ Transition::Transition(const State source, const State target)
     : source_(source), target_(target) {}
 
 Transition::Transition(const Transition& transition)
-    : source_(transition.source_), target_(transition.target_) {}
+    : source_(transition.source_),
+      target_(transition.target_),
+      delta_(transition.delta_) {}
+
+Transition Transition::Counting(const State& counter, int delta,
+                                const State& underflow) {
+  assert(counter.isCounter() && delta);
+  Transition transition(counter, underflow);
+  transition.delta_ = delta;
+  return transition;
+}
+
+std::optional<Transition> Transition::From(const State& source) const {
+  if (!delta_) return Transition(source, target_);
+
+  int count = source.Count() + delta_;
+  if (count < 0) return Transition(source, target_);
+  if (count >= source.CountNum()) return std::nullopt;
+  return Transition(source, source.WithCount(count));
+}
 
 void Transition::addTransitionRule(std::weak_ptr<TransitionRule> arg) {
   transition_args_.push_back(std::weak_ptr<TransitionRule>(arg));
@@ -211,6 +285,7 @@ void Transition::addTransitionRule(std::weak_ptr<TransitionRule> arg) {
 Transition& Transition::operator=(const Transition& transition) {
   source_ = transition.source_;
   target_ = transition.target_;
+  delta_ = transition.delta_;
   return *this;
 }
 
@@ -219,7 +294,8 @@ bool Transition::operator<(const Transition& transition) const {
 }
 
 bool Transition::operator==(const Transition& transition) const {
-  return source_ == transition.source_ && target_ == transition.target_;
+  return source_ == transition.source_ && target_ == transition.target_ &&
+         delta_ == transition.delta_;
 }
 
 llvm::raw_ostream& operator<<(llvm::raw_ostream& ostream,
@@ -228,33 +304,45 @@ llvm::raw_ostream& operator<<(llvm::raw_ostream& ostream,
   return ostream;
 }
 
-TransitionLogs::TransitionLogs()
-    : transition_logs_(),
-      warned_(false) {}
+TransitionLogs::TransitionLogs() = default;
 
-TransitionLogs::TransitionLogs(const TransitionLogs& logs)
-  : transition_logs_(logs.transition_logs_) {
-    least_significant_source_ = logs.least_significant_source_;
-    most_significant_target_ = logs.most_significant_target_;
-  }
+TransitionLogs::TransitionLogs(const TransitionLogs& logs) = default;
 
 TransitionLogs::TransitionLogs(
     Transition transition, std::shared_ptr<framework::Instruction> instruction)
-    : transition_logs_{Log{transition, instruction}} {
-  least_significant_source_ = transition.Source();
-  most_significant_target_ = transition.Target();
+    : TransitionLogs() {
+  addTransition(transition, instruction);
+}
+
+TransitionLogs::~TransitionLogs() { release(tail_); }
+
+void TransitionLogs::release(std::shared_ptr<const Node>& node) {
+  // Free the nodes owned only by |node| one by one, so that a long history is
+  // not freed recursively
+  while (node && node.use_count() == 1) {
+    auto prev = node->prev;
+    node = std::move(prev);
+  }
+  node.reset();
 }
 
 const State& TransitionLogs::CurrentState() const {
-  assert(!transition_logs_.empty());
+  assert(tail_);
 
-  return transition_logs_.back().transition.Target();
+  return tail_->log.transition.Target();
 }
 
 void TransitionLogs::addTransition(
-    framework::Transition& transition,
+    const framework::Transition& transition,
     std::shared_ptr<framework::Instruction> instruction) {
-  transition_logs_.push_back(Log{transition, instruction});
+  tail_ = std::make_shared<const Node>(
+      Node{Log{transition, instruction}, std::move(tail_)});
+  fingerprint_ = HashCombine(
+      HashCombine(fingerprint_, transition.Source().Fingerprint()),
+      HashCombine(transition.Target().Fingerprint(),
+                  reinterpret_cast<uintptr_t>(instruction.get())));
+
+  if (!first_source_) first_source_ = transition.Source();
 
   if (!least_significant_source_ ||
       transition.Source() < *least_significant_source_)
@@ -268,9 +356,13 @@ void TransitionLogs::addTransition(
 void TransitionLogs::setWarned() { warned_ = true; }
 
 void TransitionLogs::generateLog(llvm::raw_ostream& stream) const {
-  for (auto log : transition_logs_) {
-    auto transition = log.transition;
-    framework::generateLog(stream, log.instruction.get(),
+  std::vector<const Log*> logs;
+  for (auto node = tail_.get(); node; node = node->prev.get())
+    logs.push_back(&node->log);
+
+  for (auto log = logs.rbegin(); log != logs.rend(); log++) {
+    auto& transition = (*log)->transition;
+    framework::generateLog(stream, (*log)->instruction.get(),
                            "[Transition] " + transition.Source().Name() +
                                " to " + transition.Target().Name());
   }
@@ -278,24 +370,47 @@ void TransitionLogs::generateLog(llvm::raw_ostream& stream) const {
 
 void TransitionLogs::logicalTerminate(
     std::shared_ptr<framework::Instruction> instruction) {
-  auto null_transition = Transition(transition_logs_.back().transition.Target(),
-                                    NullState::GetInstance());
+  auto null_transition =
+      Transition(tail_->log.transition.Target(), NullState::GetInstance());
   addTransition(null_transition, instruction);
 }
 
 Transition TransitionLogs::ReducedTransition() const {
-  return Transition(transition_logs_.front().transition.Source(),
-                    transition_logs_.back().transition.Target());
+  return Transition(*first_source_, tail_->log.transition.Target());
+}
+
+TransitionLogs TransitionLogs::Collapsed() const {
+  TransitionLogs logs(ReducedTransition(), CurrentInstruction());
+  logs.least_significant_source_ = least_significant_source_;
+  logs.most_significant_target_ = most_significant_target_;
+  return logs;
+}
+
+size_t TransitionLogs::Size() const {
+  size_t size = 0;
+  for (auto node = tail_.get(); node; node = node->prev.get()) size++;
+  return size;
 }
 
 bool TransitionLogs::operator==(const TransitionLogs& logs) const {
-  return transition_logs_ == logs.transition_logs_;
+  if (fingerprint_ != logs.fingerprint_) return false;
+
+  // Walk both lists until they meet on a shared node
+  auto lhs = tail_.get(), rhs = logs.tail_.get();
+  for (; lhs != rhs; lhs = lhs->prev.get(), rhs = rhs->prev.get()) {
+    if (!lhs || !rhs || !(lhs->log == rhs->log)) return false;
+  }
+  return true;
 }
 
 TransitionLogs& TransitionLogs::operator=(const TransitionLogs& logs) {
-  transition_logs_ = std::vector<Log>(logs.transition_logs_);
+  auto tail = logs.tail_;
+  release(tail_);
+  tail_ = std::move(tail);
+  first_source_ = logs.first_source_;
   least_significant_source_ = logs.least_significant_source_;
   most_significant_target_ = logs.most_significant_target_;
+  fingerprint_ = logs.fingerprint_;
   return *this;
 }
 
@@ -347,9 +462,12 @@ void StateTransitionManager::addTransitionRule(Transition& transition,
 void StateTransitionManager::registerFunctionArgTransition(
     const FunctionArgTransitionRule::FunctionArg& arg,
     framework::Transition transition) {
-  if (!existsInFunctionArgTransition(arg))
-    function_transitions_[arg] = std::vector<framework::Transition>();
-  function_transitions_[arg].push_back(transition);
+  auto transitions = function_transitions_.try_emplace(arg).first;
+  transitions->second.add(transition);
+
+  auto& callee = callee_transitions_[arg.function_name];
+  if (callee.size() <= arg.arg_index) callee.resize(arg.arg_index + 1);
+  callee[arg.arg_index] = &*transitions;
 }
 
 void StateTransitionManager::registerFunctionArgTransition(
@@ -363,38 +481,31 @@ void StateTransitionManager::registerFunctionArgTransition(
 void StateTransitionManager::registerStoreTransition(
     std::shared_ptr<StoreValueTransitionRule> rule,
     framework::Transition transition) {
-  if (store_transitions_.find(rule->Type()) == store_transitions_.end())
-    store_transitions_[rule->Type()] = std::vector<framework::Transition>();
-  store_transitions_[rule->Type()].push_back(transition);
+  store_transitions_[rule->Type()].add(transition);
 
   if (rule->Type() == framework::StoreValueTransitionRule::CALL_FUNC) {
-    for (auto func : rule->FunctionNames()) {
-      if (call_store_transitions_.find(func) == call_store_transitions_.end())
-        call_store_transitions_[func] = std::vector<framework::Transition>();
-      call_store_transitions_[func].push_back(transition);
-    }
+    for (auto func : rule->FunctionNames())
+      call_store_transitions_[func].add(transition);
   }
 
   if (rule->ConsiderNullBranch()) {
     auto new_rule =
         static_cast<framework::StoreValueTransitionRule::StoreValueType>(
             rule->Type() + 4);
-    if (store_transitions_.find(new_rule) == store_transitions_.end())
-      store_transitions_[new_rule] = std::vector<framework::Transition>();
-    store_transitions_[new_rule].push_back(transition);
+    store_transitions_[new_rule].add(transition);
   }
 }
 
 void StateTransitionManager::registerUseTransition(
-    std::shared_ptr<UseValueTransitionRule> rule,
+    std::shared_ptr<UseValueTransitionRule> /* rule */,
     framework::Transition transition) {
-  use_transitions_.push_back(transition);
+  use_transitions_.add(transition);
 }
 
 void StateTransitionManager::registerAliasTransition(
-    std::shared_ptr<AliasValueTransitionRule> rule,
+    std::shared_ptr<AliasValueTransitionRule> /* rule */,
     framework::Transition transition) {
-  alias_transitions_.push_back(transition);
+  alias_transitions_.add(transition);
 }
 
 bool StateTransitionManager::existsInFunctionArgTransition(
@@ -402,40 +513,230 @@ bool StateTransitionManager::existsInFunctionArgTransition(
   return function_transitions_.find(arg) != function_transitions_.end();
 }
 
-const std::pair<FunctionArgTransitionRule::FunctionArg,
-                std::vector<framework::Transition>>
-/* const std::vector<framework::Transition> */
+const StateTransitionManager::FunctionArgTransitions*
 StateTransitionManager::getFunctionArgTransitions(const std::string& name,
                                                   unsigned int arg_num) {
-  FunctionArgTransitionRule::FunctionArg arg(name, arg_num);
-  if (existsInFunctionArgTransition(arg)) {
-    return *function_transitions_.find(arg);
-  }
-  return std::make_pair(arg, std::vector<framework::Transition>());
+  auto callee = getCalleeTransitions(name);
+  if (!callee || arg_num >= callee->size()) return nullptr;
+  return (*callee)[arg_num];
+}
+
+const std::vector<const StateTransitionManager::FunctionArgTransitions*>*
+StateTransitionManager::getCalleeTransitions(const std::string& name) {
+  auto callee = callee_transitions_.find(name);
+  if (callee == callee_transitions_.end()) return nullptr;
+  return &callee->second;
 }
 
-std::vector<framework::Transition>
-StateTransitionManager::getStoreArgTransitions(
+const TransitionTable& StateTransitionManager::getStoreArgTransitions(
     framework::StoreValueTransitionRule::StoreValueType type,
     const std::string& name) {
-  std::vector<framework::Transition> transitions;
+  static const TransitionTable empty_table;
   if (type == framework::StoreValueTransitionRule::CALL_FUNC) {
-    if (call_store_transitions_.find(name) != call_store_transitions_.end())
-      return call_store_transitions_[name];
+    auto transitions = call_store_transitions_.find(name);
+    if (transitions != call_store_transitions_.end())
+      return transitions->second;
   } else {
-    if (store_transitions_.find(type) != store_transitions_.end())
-      return store_transitions_[type];
+    auto transitions = store_transitions_.find(type);
+    if (transitions != store_transitions_.end()) return transitions->second;
+  }
+  return empty_table;
+}
+
+std::set<std::string> StateTransitionManager::CalleeNames() const {
+  std::set<std::string> names;
+  for (const auto& callee : callee_transitions_) names.insert(callee.first);
+  for (const auto& callee : call_store_transitions_)
+    names.insert(callee.first);
+  return names;
+}
+
+StateTransitionManager::InstructionTriggers&
+StateTransitionManager::InstructionTriggers::operator|=(
+    const InstructionTriggers& triggers) {
+  load |= triggers.load;
+  store |= triggers.store;
+  null_store |= triggers.null_store;
+  null_branch |= triggers.null_branch;
+  return *this;
+}
+
+StateTransitionManager::InstructionTriggers
+StateTransitionManager::UncalledTriggers(bool init_only) const {
+  auto fires = [init_only](const TransitionTable& transitions) {
+    return init_only ? transitions.InitTransition() != nullptr
+                     : !transitions.empty();
+  };
+
+  InstructionTriggers triggers;
+  triggers.load = fires(use_transitions_);
+  // Aliases are checked on stores
+  triggers.store = fires(alias_transitions_);
+
+  // Stores of a call result are keyed by the callee. Types past the branch
+  // considered ones are never looked up.
+  for (const auto& [type, transitions] : store_transitions_) {
+    if (!fires(transitions)) continue;
+    switch (type) {
+      case framework::StoreValueTransitionRule::NULL_VAL:
+        triggers.null_store = true;
+        break;
+      case framework::StoreValueTransitionRule::NON_NULL_VAL:
+      case framework::StoreValueTransitionRule::ANY:
+        triggers.store = true;
+        break;
+      case framework::StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_NULL:
+      case framework::StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_NON_NULL:
+      case framework::StoreValueTransitionRule::NULL_BRANCH_CONSIDERED_ANY:
+        triggers.null_branch = true;
+        break;
+      default:
+        break;
+    }
+  }
+  return triggers;
+}
+
+bool StateTransitionManager::HasLocalTrigger(
+    const llvm::Function& function, const std::set<std::string>& callee_names,
+    const InstructionTriggers& triggers) {
+  auto is_null = [](const llvm::Value* value) {
+    return llvm::isa<llvm::ConstantPointerNull>(value);
+  };
+
+  for (auto& inst : llvm::instructions(function)) {
+    if (auto call_inst = llvm::dyn_cast<llvm::CallBase>(&inst)) {
+      auto callee = llvm::dyn_cast<llvm::Function>(
+          call_inst->getCalledOperand()->stripPointerCastsAndAliases());
+      if (!callee) continue;
+      auto name = callee->getName().str();
+      if (callee_names.find(name) != callee_names.end() ||
+          (triggers.store && findFunctionName(name, "memset")))
+        return true;
+    } else if (auto store_inst = llvm::dyn_cast<llvm::StoreInst>(&inst)) {
+      if (triggers.store ||
+          (triggers.null_store && is_null(store_inst->getValueOperand())))
+        return true;
+    } else if (llvm::isa<llvm::LoadInst>(inst)) {
+      if (triggers.load) return true;
+    } else if (auto compare_inst = llvm::dyn_cast<llvm::CmpInst>(&inst)) {
+      if (triggers.null_branch && (is_null(compare_inst->getOperand(0)) ||
+                                   is_null(compare_inst->getOperand(1))))
+        return true;
+    }
   }
-  return std::vector<framework::Transition>();
+  return false;
 }
 
-std::vector<framework::Transition>
-StateTransitionManager::getUseValueTransitions() {
-  return use_transitions_;
+std::set<const llvm::Function*> StateTransitionManager::AnalyzedFunctions(
+    const llvm::Module& module, const std::set<std::string>& callee_names,
+    const InstructionTriggers& triggers) {
+  std::set<const llvm::Function*> triggering;
+  std::vector<const llvm::Function*> worklist;
+  for (auto& function : module) {
+    if (HasLocalTrigger(function, callee_names, triggers))
+      worklist.push_back(&function);
+  }
+  while (!worklist.empty()) {
+    auto function = worklist.back();
+    worklist.pop_back();
+    if (!triggering.insert(function).second) continue;
+    for (auto user : function->users()) {
+      auto call_inst = llvm::dyn_cast<llvm::CallBase>(user);
+      if (call_inst && call_inst->getCalledOperand() == function)
+        worklist.push_back(call_inst->getFunction());
+    }
+  }
+
+  // Then the callees whose result an analyzed function uses
+  std::set<const llvm::Function*> analyzed;
+  worklist.assign(triggering.begin(), triggering.end());
+  while (!worklist.empty()) {
+    auto function = worklist.back();
+    worklist.pop_back();
+    if (!analyzed.insert(function).second) continue;
+    for (auto& inst : llvm::instructions(function)) {
+      auto call_inst = llvm::dyn_cast<llvm::CallBase>(&inst);
+      if (!call_inst || call_inst->use_empty()) continue;
+      auto callee = llvm::dyn_cast<llvm::Function>(
+          call_inst->getCalledOperand()->stripPointerCastsAndAliases());
+      if (callee && !callee->isDeclaration()) worklist.push_back(callee);
+    }
+  }
+  return analyzed;
+}
+
+/* TransitionTable Class */
+TransitionTable::TransitionTable(const std::vector<Transition>& transitions) {
+  for (auto& transition : transitions) add(transition);
+}
+
+size_t TransitionTable::Slot(const State& state) {
+  if (state.ID() >= 0 && state.ID() < State::kStateMaxNum) return state.ID();
+  if (state.ID() >= State::kBugStateIDBase)
+    return State::kStateMaxNum + state.ID() - State::kBugStateIDBase;
+  return kNoSlot;
+}
+
+void TransitionTable::add(const Transition& transition) {
+  size_++;
+  if (transition.Source().isInitState() &&
+      (!init_transition_ ||
+       transition.Target() < init_transition_->Target()))
+    init_transition_ = transition;
+
+  // Transitions from a single count of a counter are matched exactly
+  size_t slot = Slot(transition.Source());
+  if (slot == kNoSlot ||
+      (transition.Source().isCounter() && !transition.isCounting())) {
+    auto found = std::find_if(
+        sparse_sources_.begin(), sparse_sources_.end(),
+        [&](const Transition& sparse) {
+          return sparse.Source() == transition.Source();
+        });
+    if (found == sparse_sources_.end()) sparse_sources_.push_back(transition);
+    return;
+  }
+
+  if (by_source_.size() <= slot) by_source_.resize(slot + 1);
+  if (!by_source_[slot]) by_source_[slot] = transition;
 }
 
-std::vector<framework::Transition>
-StateTransitionManager::getAliasTransitions() {
-  return alias_transitions_;
+std::optional<Transition> TransitionTable::find(const State& source) const {
+  size_t slot = Slot(source);
+  if (slot == kNoSlot || source.isCounter()) {
+    for (auto& transition : sparse_sources_) {
+      if (transition.Source() == source) return transition;
+    }
+    if (slot == kNoSlot) return std::nullopt;
+  }
+
+  if (by_source_.size() <= slot || !by_source_[slot]) return std::nullopt;
+  return by_source_[slot]->From(source);
+}
+
+/* TransitionSet Class */
+void TransitionSet::add(const TransitionTable& table) {
+  if (table.empty()) return;
+  assert(size_ < kMaxTables);
+  tables_[size_++] = &table;
+}
+
+std::optional<Transition> TransitionSet::find(const State& source) const {
+  for (size_t i = 0; i < size_; i++) {
+    if (auto transition = tables_[i]->find(source)) return transition;
+  }
+  return std::nullopt;
+}
+
+const Transition* TransitionSet::InitTransition() const {
+  const Transition* init_transition = nullptr;
+  for (size_t i = 0; i < size_; i++) {
+    auto transition = tables_[i]->InitTransition();
+    if (transition && (!init_transition ||
+                       transition->Target() < init_transition->Target()))
+      init_transition = transition;
+  }
+  return init_transition;
 }
 };  // namespace framework
@@ -56,7 +56,7 @@ FunctionArgTransitionRule::FunctionArgTransitionRule(
 
 FunctionArgTransitionRule::FunctionArgTransitionRule(
     std::vector<FunctionArg> args)
-    : function_args_(args), TransitionRule(TransitionTrigger::FUNCTION_ARG) {}
+    : TransitionRule(TransitionTrigger::FUNCTION_ARG), function_args_(args) {}
 
 FunctionArgTransitionRule::FunctionArgTransitionRule(std::string name)
     : TransitionRule(TransitionTrigger::FUNCTION_ARG) {
@@ -72,9 +72,9 @@ FunctionArgTransitionRule::FunctionArgTransitionRule(
 StoreValueTransitionRule::StoreValueTransitionRule(
     StoreValueType type, std::vector<std::string> funcs)
     : TransitionRule(TransitionTrigger::STORE_VALUE),
-      type_(type),
+      consider_null_branch_(true),
       function_names_(funcs),
-      consider_null_branch_(true) {}
+      type_(type) {}
 
 UseValueTransitionRule::UseValueTransitionRule()
     : TransitionRule(TransitionTrigger::USE_VALUE) {}
@@ -0,0 +1,79 @@
+#include "frontend/WorkStealingPool.hpp"
+
+// include STL
+#include <thread>
+#include <utility>
+
+namespace framework {
+WorkStealingPool::WorkStealingPool(size_t worker_num)
+    : pending_(0), queued_(0) {
+  if (!worker_num) worker_num = 1;
+  for (size_t i = 0; i < worker_num; i++)
+    queues_.push_back(std::make_unique<Queue>());
+}
+
+void WorkStealingPool::push(size_t worker, Task task) {
+  pending_++;
+  {
+    auto& queue = *queues_[worker % queues_.size()];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+    queued_++;
+  }
+
+  // Taking the lock orders the push before the check of a worker going idle
+  { std::lock_guard<std::mutex> guard(idle_mutex_); }
+  idle_.notify_one();
+}
+
+void WorkStealingPool::run() {
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < queues_.size(); i++)
+    threads.emplace_back([this, i]() { work(i); });
+
+  // The calling thread is the first worker
+  work(0);
+  for (auto& thread : threads) thread.join();
+}
+
+void WorkStealingPool::work(size_t worker) {
+  while (true) {
+    Task task;
+    if (pop(worker, task) || steal(worker, task)) {
+      task(worker);
+      if (--pending_ == 0) {
+        { std::lock_guard<std::mutex> guard(idle_mutex_); }
+        idle_.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(idle_mutex_);
+    idle_.wait(lock, [this]() { return queued_ > 0 || pending_ == 0; });
+    if (pending_ == 0) return;
+  }
+}
+
+bool WorkStealingPool::pop(size_t worker, Task& task) {
+  auto& queue = *queues_[worker];
+  std::lock_guard<std::mutex> guard(queue.mutex);
+  if (queue.tasks.empty()) return false;
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  queued_--;
+  return true;
+}
+
+bool WorkStealingPool::steal(size_t worker, Task& task) {
+  for (size_t i = 1; i < queues_.size(); i++) {
+    auto& queue = *queues_[(worker + i) % queues_.size()];
+    std::lock_guard<std::mutex> guard(queue.mutex);
+    if (queue.tasks.empty()) continue;
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    queued_--;
+    return true;
+  }
+  return false;
+}
+}  // namespace framework
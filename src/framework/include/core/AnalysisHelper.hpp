@@ -15,12 +15,6 @@ std::vector<framework::Value::Fields> decodeGetElementPtrInst(
     llvm::GetElementPtrInst *get_element_ptr_inst);
 long arrayElementNum(llvm::GetElementPtrInst *get_element_ptr_inst);
 
-static std::vector<long> getValueIndices(llvm::GetElementPtrInst *inst);
-static long getMemberIndiceFromByte(llvm::Instruction *instruction,
-                                    llvm::StructType *STy, uint64_t byte);
-static const llvm::StructLayout *getStructLayout(llvm::Instruction *instruction,
-                                                 llvm::StructType *STy);
-
 bool isInPredecessor(std::shared_ptr<framework::BasicBlock> target,
                      std::shared_ptr<framework::BasicBlock> block, int depth);
 }  // namespace framework
@@ -1,4 +1,7 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <memory>
 #include <set>
 #include <vector>
@@ -10,6 +13,59 @@ namespace framework {
 // TODO: remove this prototype from here
 class Function;
 class BranchInst;
+class BasicBlock;
+
+// Neighbours of a block: a row of the CSR adjacency of its function, over the
+// block IDs. Iterating hands out the blocks of the function by reference.
+class BlockList {
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::shared_ptr<BasicBlock>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    const_iterator(const std::shared_ptr<BasicBlock>* blocks,
+                   const uint32_t* id)
+        : blocks_(blocks), id_(id) {}
+
+    const std::shared_ptr<BasicBlock>& operator*() const {
+      return blocks_[*id_];
+    }
+    const_iterator& operator++() {
+      id_++;
+      return *this;
+    }
+    bool operator==(const const_iterator& iterator) const {
+      return id_ == iterator.id_;
+    }
+    bool operator!=(const const_iterator& iterator) const {
+      return id_ != iterator.id_;
+    }
+
+   private:
+    const std::shared_ptr<BasicBlock>* blocks_;
+    const uint32_t* id_;
+  };
+
+  BlockList() : blocks_(nullptr), begin_(nullptr), end_(nullptr) {}
+  BlockList(const std::shared_ptr<BasicBlock>* blocks, const uint32_t* begin,
+            const uint32_t* end)
+      : blocks_(blocks), begin_(begin), end_(end) {}
+
+  const_iterator begin() const { return const_iterator(blocks_, begin_); }
+  const_iterator end() const { return const_iterator(blocks_, end_); }
+  size_t size() const { return end_ - begin_; }
+  bool empty() const { return begin_ == end_; }
+
+ private:
+  const std::shared_ptr<BasicBlock>* blocks_;
+  const uint32_t* begin_;
+  const uint32_t* end_;
+};
+
 class BasicBlock {
  public:
   constexpr static long kNoId = -1;
@@ -28,18 +84,24 @@ class BasicBlock {
       const std::shared_ptr<framework::BasicBlock> basic_block,
       const llvm::BasicBlock* llvm_block);
 
+  // Edges are collected while the CFG is built, and read through the
+  // adjacency set by Function::buildControlFlowGraph
   void addSuccessor(std::shared_ptr<framework::BasicBlock> block);
   void addPredecessor(std::shared_ptr<framework::BasicBlock> block);
   bool isInPredecessor(std::shared_ptr<framework::BasicBlock> block);
 
-  const std::set<std::weak_ptr<framework::BasicBlock>>& Predecessors() {
-    return predecessors_;
+  const std::vector<framework::BasicBlock*>& AddedSuccessors() {
+    return added_successors_;
   }
-
-  const std::set<std::weak_ptr<framework::BasicBlock>>& Successors() {
-    return successors_;
+  const std::vector<framework::BasicBlock*>& AddedPredecessors() {
+    return added_predecessors_;
   }
 
+  void setAdjacency(BlockList predecessors, BlockList successors);
+
+  const BlockList& Predecessors() { return predecessors_; }
+  const BlockList& Successors() { return successors_; }
+
   void addInstruction(std::shared_ptr<framework::Instruction> inst);
   const std::vector<std::shared_ptr<framework::Instruction>> Instructions() {
     return instructions_;
@@ -93,8 +155,10 @@ class BasicBlock {
   // Values to be dead by the end of this BB
   std::set<std::shared_ptr<framework::Value>> dead_values_;
 
-  // Interactions
-  std::set<std::weak_ptr<framework::BasicBlock>> predecessors_;
-  std::set<std::weak_ptr<framework::BasicBlock>> successors_;
+  // Interactions. The blocks are owned by the parent function.
+  std::vector<framework::BasicBlock*> added_predecessors_;
+  std::vector<framework::BasicBlock*> added_successors_;
+  BlockList predecessors_;
+  BlockList successors_;
 };
 }  // namespace framework
@@ -1,13 +1,17 @@
 #pragma once
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <string>
 #include <vector>
 
 #include "core/BasicBlock.hpp"
 #include "core/Value.hpp"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/InstrTypes.h"
 
 namespace framework {
 const std::vector<std::string> err_functions{"IS_ERR", "PTR_ERR"};
@@ -21,6 +25,36 @@ class Function {
       std::map<std::shared_ptr<framework::BasicBlock>,
                std::shared_ptr<framework::Value>>;
 
+  // Null check made by the branch of a predecessor, for one incoming edge
+  struct EdgeFacts {
+    // Value compared with NULL, or nullptr when the edge checks none
+    std::shared_ptr<framework::Value> null_checked;
+    // Whether the value is NULL along the edge
+    bool is_null = false;
+  };
+
+  // Comparison with a constant made by the branch of a block. Branches on
+  // other conditions keep the defaults, which compare with the success code.
+  struct BranchFacts {
+    llvm::CmpInst::Predicate predicate = llvm::CmpInst::ICMP_NE;
+    int64_t compared_value = 0;
+    bool is_null = false;
+  };
+
+  // Classification of a function by its name, computed once on creation
+  enum Kind : uint32_t {
+    kDebugFunction = 1 << 0,
+    kDebugValueFunction = 1 << 1,
+    kDebugDeclareFunction = 1 << 2,
+    kLifetimeEndFunction = 1 << 3,
+    kExpectFunction = 1 << 4,
+    kMemSetFunction = 1 << 5,
+    kRefcountDecrementFunction = 1 << 6,
+    kErrorFunction = 1 << 7,
+  };
+
+  static uint32_t Classify(const std::string& name);
+
   // Factory method to create and manage functions
   static std::shared_ptr<framework::Function> createManagedFunction(
       llvm::Function* function, std::unique_ptr<llvm::LoopInfo> loop_info =
@@ -44,10 +78,12 @@ class Function {
 
   Function(llvm::Function* function, std::unique_ptr<llvm::LoopInfo> loop_info);
 
+  // Returns nullptr for blocks of other functions. The blocks are all built
+  // on the first call.
   std::shared_ptr<framework::BasicBlock> getBasicBlock(
       llvm::BasicBlock* basic_block);
 
-  const std::set<std::shared_ptr<framework::BasicBlock>>& BasicBlocks() {
+  const std::vector<std::shared_ptr<framework::BasicBlock>>& BasicBlocks() {
     return basic_blocks_;
   }
 
@@ -66,16 +102,13 @@ class Function {
   };
 
   const llvm::Type* ReturnType() { return return_type_; }
-  std::string Name() { return function_name_; };
+  const std::string& Name() { return function_name_; };
+  // Dense ID in the order the functions were created
+  uint32_t Id() { return id_; }
   bool isDeclaration() { return is_definition_; };
-  bool isDebugFunction() {
-    return function_name_.find("llvm.dbg") != std::string::npos;
-  }
-
-  bool isErrorFunction() {
-    return std::find(err_functions.begin(), err_functions.end(),
-                     function_name_) != err_functions.end();
-  }
+  bool isKind(uint32_t kind) { return kind_ & kind; }
+  bool isDebugFunction() { return isKind(kDebugFunction); }
+  bool isErrorFunction() { return isKind(kErrorFunction); }
 
   uint64_t ArgSize() { return arg_size_; }
 
@@ -89,8 +122,14 @@ class Function {
   std::shared_ptr<framework::BasicBlock> ReturnBlock() { return return_block_; }
   static std::map<llvm::Function*, std::shared_ptr<framework::Function>>
   CreatedFunctions() {
+    std::lock_guard<std::mutex> guard(created_functions_mutex_);
     return created_functions_;
   }
+  // Upper bound of the IDs of the functions created so far
+  static size_t CreatedFunctionNum() {
+    std::lock_guard<std::mutex> guard(created_functions_mutex_);
+    return created_functions_.size();
+  }
 
   void addCallerFunction(std::shared_ptr<framework::Function> caller);
   const std::set<std::shared_ptr<framework::Function>>& CallerFunctions();
@@ -121,18 +160,51 @@ class Function {
     return ordered_basic_blocks_;
   }
 
+  // Builds the CSR adjacency of the blocks over their IDs, which index
+  // OrderedBasicBlocks(), along with the facts of the branches. Should be
+  // called once every block has an ID.
+  void buildControlFlowGraph();
+
+  // Facts of the incoming edges of |block|, in the order of its Predecessors()
+  const EdgeFacts* PredecessorFacts(framework::BasicBlock& block) {
+    return predecessor_facts_.data() + predecessor_offsets_[block.Id()];
+  }
+
+  const BranchFacts& getBranchFacts(framework::BasicBlock& block) {
+    return branch_facts_[block.Id()];
+  }
+
+  // Should be called once the CFG of the function is built. The instructions
+  // of the blocks are numbered in this order.
+  void computeReversePostOrder();
+
+  const std::vector<std::shared_ptr<framework::BasicBlock>>&
+  ReversePostOrderBlocks() {
+    return reverse_post_order_blocks_;
+  }
+
  private:
+  // Builds every block of the function and its edges in a single pass
+  void buildBasicBlocks();
+
+  // Evaluates the comparisons of the branches once the adjacency is set
+  void buildBranchFacts();
+
   static std::map<llvm::Function*, std::shared_ptr<framework::Function>>
       created_functions_;
+  static std::mutex created_functions_mutex_;
 
   // Function metas these should be updated to copy llvm::Function, but for the
   // time being, we manually copy everything
   llvm::Function* llvm_function_;
+  uint32_t id_;
 
   const llvm::Type* return_type_;
 
   std::unique_ptr<llvm::LoopInfo> loop_info_;
   std::string function_name_;
+  // Classified from the name, so declared after it
+  uint32_t kind_;
   bool is_definition_;
   uint64_t arg_size_;
 
@@ -143,10 +215,24 @@ class Function {
   PossibleReturnAssignmentMap return_assignment_;
 
   std::set<std::shared_ptr<framework::Function>> caller_functions_;
-  std::set<std::shared_ptr<framework::BasicBlock>> basic_blocks_;
+  // Blocks in the order of the llvm function, and the index of each
+  bool basic_blocks_built_ = false;
+  std::vector<std::shared_ptr<framework::BasicBlock>> basic_blocks_;
+  llvm::DenseMap<llvm::BasicBlock*, uint32_t> basic_block_index_;
 
   // TODO: Update to ordered basic block after it is proven worthy
   std::vector<std::shared_ptr<framework::BasicBlock>> ordered_basic_blocks_;
+  std::vector<std::shared_ptr<framework::BasicBlock>> reverse_post_order_blocks_;
+
+  // CSR adjacency. The neighbours of block i are ids[offsets[i]:offsets[i+1]]
+  std::vector<uint32_t> predecessor_offsets_;
+  std::vector<uint32_t> predecessor_ids_;
+  std::vector<uint32_t> successor_offsets_;
+  std::vector<uint32_t> successor_ids_;
+
+  // Indexed like predecessor_ids_, and by the block ID
+  std::vector<EdgeFacts> predecessor_facts_;
+  std::vector<BranchFacts> branch_facts_;
 
   std::shared_ptr<framework::BasicBlock> init_block_;
   std::shared_ptr<framework::BasicBlock> return_block_;
@@ -0,0 +1,18 @@
+#pragma once
+// include STL
+#include <cstdint>
+
+namespace framework {
+// Spreads the bits of |value| (the finalizer of splitmix64)
+inline uint64_t HashMix(uint64_t value) {
+  value += 0x9e3779b97f4a7c15ULL;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+// Order dependent combination of two hashes
+inline uint64_t HashCombine(uint64_t seed, uint64_t value) {
+  return HashMix(seed ^ (HashMix(value) + (seed << 6) + (seed >> 2)));
+}
+}  // namespace framework
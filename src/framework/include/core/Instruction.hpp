@@ -11,6 +11,8 @@ namespace framework {
 class BasicBlock;
 class Instruction : public Value {
  public:
+  static constexpr uint32_t kNoOrder = UINT32_MAX;
+
   static std::shared_ptr<Instruction> Create(std::shared_ptr<Instruction> inst,
                                              std::vector<Fields> field,
                                              long array_element_num);
@@ -25,6 +27,8 @@ class Instruction : public Value {
   Instruction(std::shared_ptr<Instruction> instruction,
               std::vector<Fields> fields, long array_element_num);
 
+  // Program order within a function when both are numbered, source order
+  // otherwise
   bool operator<=(const framework::Instruction& instruction) const;
 
   bool operator<(llvm::Instruction* instruction) const;
@@ -38,16 +42,24 @@ class Instruction : public Value {
   bool isInSameLine(framework::Instruction inst);
   bool emptyInstruction();
 
-  const unsigned int Line() { return line_; };
-  const unsigned int Column() { return column_; };
-  const unsigned int Opcode() const { return opcode_; };
+  unsigned int Line() { return line_; };
+  unsigned int Column() {
+    return getDebugLoc() ? getDebugLoc().getCol() : 0;
+  };
+  unsigned int Opcode() const { return opcode_; };
   const std::string OpcodeName() const {
     return llvm::Instruction::getOpcodeName(opcode_);
   }
   const llvm::Module* Module() const { return module_; }
+
+  // Position in the reverse post order of the function, set by
+  // Function::computeReversePostOrder
+  uint32_t Order() const { return order_; }
+  void setOrder(uint32_t order) { order_ = order; }
   const std::weak_ptr<framework::BasicBlock> Parent() const { return parent_; }
 
-  const llvm::DebugLoc& getDebugLoc() { return debug_loc_; };
+  // Read from the LLVM instruction, which outlives this instruction
+  const llvm::DebugLoc& getDebugLoc();
   llvm::Instruction* LLVMInstruction() { return llvm_instruction_; };
 
   static bool classof(const framework::Value* value) {
@@ -60,10 +72,8 @@ class Instruction : public Value {
   llvm::Module* module_;
   std::weak_ptr<framework::BasicBlock> parent_;
 
-  llvm::DebugLoc debug_loc_;
-
   unsigned int opcode_;
-  unsigned int column_;
-  unsigned int line_;
+  unsigned int line_ = 0;
+  uint32_t order_ = kNoOrder;
 };
 }  // namespace framework
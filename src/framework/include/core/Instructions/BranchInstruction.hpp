@@ -36,7 +36,7 @@ class CompareInst : public Instruction {
   std::shared_ptr<framework::Value> find_if(
       std::function<bool(std::shared_ptr<framework::Value>)> lambda);
 
-  const llvm::CmpInst::Predicate GetPredicate() const { return predicate_; }
+  llvm::CmpInst::Predicate GetPredicate() const { return predicate_; }
 
   /// Methods for support type inquiry through isa, cast, and dyn_cast:
   static bool classof(const framework::Instruction* I) {
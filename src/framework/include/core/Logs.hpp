@@ -50,11 +50,20 @@ struct EndPoints {
 
 class LoggingClient {
  public:
-  LoggingClient();
+  LoggingClient() : LoggingClient(true) {}
+  // Clients which are only drained with extract() need no end points
+  explicit LoggingClient(bool with_end_points);
 
   void log(const std::string& log);
   void flush();
 
+  // Size of the logs which are not flushed yet. Used with truncate() to
+  // discard logs of an analysis which is going to be redone.
+  size_t Size() { return buffer_.size(); }
+  void truncate(size_t size);
+  // Removes and returns the logs added since Size() returned |size|
+  std::string extract(size_t size);
+
   void printLog();
 
   LoggingClient& operator<<(const std::string& log);
@@ -0,0 +1,257 @@
+#pragma once
+// include STL
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "core/Hashing.hpp"
+
+namespace framework {
+/* Map from keys with dense 32 bit IDs with structural sharing. KeyID()(key)
+ * gives the ID of a key, assigning one when the key has none, and is only
+ * called for keys that are stored. KeyID::Find(key) gives the ID of a key
+ * without assigning one, or kNoID when the key has none and so is in no map. Copying the map is O(1), and an update only copies the nodes on the
+ * path to the updated entry which are still shared with another copy.
+ *
+ * The map is a radix trie over the ID, with 32 way nodes which only hold the
+ * children present, so that lookups index arrays instead of comparing keys.
+ * Keys with the same ID are the same key.
+ *
+ * Iteration is in ID order, which for values is the order they were first
+ * managed in. Maps keyed by pointers iterate in allocation order instead, so
+ * the values of a block, and the bugs reported for them, are listed in a
+ * different order than before this map was used. The order is reproducible
+ * when functions are analyzed on a single thread; with several threads, values
+ * shared by functions analyzed at the same time may be managed in any order.
+ *
+ * Entries are read with lookup() and written with set(), which copies the
+ * nodes still shared with another map, so that an update can never leak into
+ * a copy. Pointers returned by lookup() stay valid until the next update.
+ *
+ * Requires T::Fingerprint(). Each node keeps the fingerprint of its entries,
+ * which set() and erase() update along the path they copy, so that
+ * fingerprint() only reads the root. Nodes shared with maps read on other
+ * threads are never written. */
+template <class Key, class T, class KeyID>
+class PersistentMap {
+ public:
+  using value_type = std::pair<Key, T>;
+  static constexpr uint32_t kNoID = std::numeric_limits<uint32_t>::max();
+
+ private:
+  static constexpr unsigned kBits = 5;
+  static constexpr uint32_t kMask = (1 << kBits) - 1;
+
+  struct Node;
+  using NodePtr = std::shared_ptr<Node>;
+
+  struct Node {
+    // Bit i is set when the child (or entry) for digit i is present
+    uint32_t bitmap = 0;
+    // Children of an inner node, or entries of a leaf, in digit order
+    std::vector<NodePtr> children;
+    std::vector<value_type> entries;
+
+    // Sum of the hashes of the entries below the node
+    uint64_t fingerprint = 0;
+
+    bool has(uint32_t digit) const { return bitmap & (1u << digit); }
+    size_t position(uint32_t digit) const {
+      return __builtin_popcount(bitmap & ((1u << digit) - 1));
+    }
+  };
+
+ public:
+  class const_iterator {
+   public:
+    const_iterator() = default;
+
+    const value_type& operator*() const {
+      return path_.back().first->entries[path_.back().second];
+    }
+    const value_type* operator->() const { return &**this; }
+
+    const_iterator& operator++() {
+      path_.back().second++;
+      while (path_.back().second == size(path_.back().first)) {
+        path_.pop_back();
+        if (path_.empty()) return *this;
+        path_.back().second++;
+      }
+      if (!path_.back().first->entries.empty()) return *this;
+      pushLeft(path_.back().first->children[path_.back().second].get());
+      return *this;
+    }
+
+    bool operator==(const const_iterator& iterator) const {
+      return path_ == iterator.path_;
+    }
+    bool operator!=(const const_iterator& iterator) const {
+      return !(*this == iterator);
+    }
+
+   private:
+    friend class PersistentMap;
+    explicit const_iterator(const Node* root) {
+      if (root && root->bitmap) pushLeft(root);
+    }
+
+    static size_t size(const Node* node) {
+      return node->entries.empty() ? node->children.size()
+                                   : node->entries.size();
+    }
+
+    void pushLeft(const Node* node) {
+      for (; node->entries.empty(); node = node->children.front().get())
+        path_.emplace_back(node, 0);
+      path_.emplace_back(node, 0);
+    }
+
+    // Nodes from the root to the current leaf, with the position in each
+    std::vector<std::pair<const Node*, size_t>> path_;
+  };
+
+  PersistentMap() = default;
+
+  const_iterator begin() const { return const_iterator(root_.get()); }
+  const_iterator end() const { return const_iterator(); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return !size_; }
+
+  const T* lookup(const Key& key) const {
+    uint32_t id = KeyID::Find(key);
+    if (id == kNoID || !covers(id)) return nullptr;
+
+    const Node* node = root_.get();
+    for (unsigned shift = shift_;; shift -= kBits) {
+      uint32_t digit = (id >> shift) & kMask;
+      if (!node->has(digit)) return nullptr;
+      if (!shift) return &node->entries[node->position(digit)].second;
+      node = node->children[node->position(digit)].get();
+    }
+  }
+
+  bool contains(const Key& key) const { return lookup(key) != nullptr; }
+
+  void set(const Key& key, const T& value) {
+    uint32_t id = KeyID()(key);
+    if (!root_) root_ = std::make_shared<Node>();
+    while (!covers(id)) grow();
+
+    // Every node on the path gains the difference of the entry hashes
+    const T* previous = lookup(key);
+    uint64_t delta = hash(id, value) - (previous ? hash(id, *previous) : 0);
+
+    NodePtr* node = &root_;
+    for (unsigned shift = shift_;; shift -= kBits) {
+      *node = own(std::move(*node));
+      (*node)->fingerprint += delta;
+      uint32_t digit = (id >> shift) & kMask;
+      size_t position = (*node)->position(digit);
+
+      if (!shift) {
+        if ((*node)->has(digit)) {
+          (*node)->entries[position].second = value;
+          return;
+        }
+        (*node)->bitmap |= 1u << digit;
+        (*node)->entries.emplace((*node)->entries.begin() + position, key,
+                                 value);
+        size_++;
+        return;
+      }
+
+      if (!(*node)->has(digit)) {
+        (*node)->bitmap |= 1u << digit;
+        (*node)->children.insert((*node)->children.begin() + position,
+                                 std::make_shared<Node>());
+      }
+      node = &(*node)->children[position];
+    }
+  }
+
+  void erase(const Key& key) {
+    const T* previous = lookup(key);
+    if (!previous) return;
+    uint32_t id = KeyID::Find(key);
+    root_ = erase(std::move(root_), id, shift_, hash(id, *previous));
+    if (!root_) shift_ = 0;
+    size_--;
+  }
+
+  // Hash of the entries, independent of the shape of the trie
+  uint64_t fingerprint() const { return root_ ? root_->fingerprint : 0; }
+
+  bool operator==(const PersistentMap& map) const {
+    if (root_ == map.root_) return true;
+    if (size_ != map.size_) return false;
+
+    for (auto lhs = begin(), rhs = map.begin(); lhs != end(); ++lhs, ++rhs) {
+      if (KeyID::Find(lhs->first) != KeyID::Find(rhs->first) ||
+          !(lhs->second == rhs->second))
+        return false;
+    }
+    return true;
+  }
+
+ private:
+  bool covers(uint32_t id) const {
+    return root_ && (uint64_t(id) >> (shift_ + kBits)) == 0;
+  }
+
+  // Adds a level above the root, which becomes the first child
+  void grow() {
+    auto root = std::make_shared<Node>();
+    if (root_->bitmap) {
+      root->bitmap = 1;
+      root->fingerprint = root_->fingerprint;
+      root->children.push_back(std::move(root_));
+    }
+    root_ = std::move(root);
+    shift_ += kBits;
+  }
+
+  // Hashes are summed, so that equal maps of any shape match
+  static uint64_t hash(uint32_t id, const T& value) {
+    return HashCombine(id, value.Fingerprint());
+  }
+
+  // Nodes referenced only by this map are updated in place
+  static NodePtr own(NodePtr node) {
+    if (node.use_count() != 1) node = std::make_shared<Node>(*node);
+    return node;
+  }
+
+  // Removes the entry of |id|, whose hash is |entry_hash|. Returns nullptr
+  // instead of a node left empty.
+  static NodePtr erase(NodePtr node, uint32_t id, unsigned shift,
+                       uint64_t entry_hash) {
+    node = own(std::move(node));
+    node->fingerprint -= entry_hash;
+    uint32_t digit = (id >> shift) & kMask;
+    size_t position = node->position(digit);
+
+    if (!shift) {
+      node->entries.erase(node->entries.begin() + position);
+      node->bitmap &= ~(1u << digit);
+    } else if (auto child = erase(std::move(node->children[position]), id,
+                                  shift - kBits, entry_hash)) {
+      node->children[position] = std::move(child);
+    } else {
+      node->children.erase(node->children.begin() + position);
+      node->bitmap &= ~(1u << digit);
+    }
+
+    if (!node->bitmap) return nullptr;
+    return node;
+  }
+
+  NodePtr root_;
+  unsigned shift_ = 0;
+  size_t size_ = 0;
+};
+}  // namespace framework
@@ -1,5 +1,7 @@
 #pragma once
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "core/Casting.hpp"
@@ -7,6 +9,8 @@
 #include "core/Value.hpp"
 #include "core/Logs.hpp"
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
 #include "llvm/IR/Value.h"
 
 namespace framework {
@@ -30,8 +34,12 @@ class Converter {
       ValueSignature signature);
   std::shared_ptr<framework::Value> ConvertValue(ValueSignature signature);
 
-  void manageValue(llvm::Value* value,
-                   std::shared_ptr<framework::Value> framework_value);
+  // Registers a created value under the signature it was created with
+  void manageValue(std::shared_ptr<framework::Value> framework_value);
+
+  // Analyzers running on different threads share the managed values, so
+  // lookups and creations have to be done under this lock
+  std::recursive_mutex& Mutex() { return mutex_; }
 
   template <class FrameworkClass, class LLVMClass>
   std::shared_ptr<FrameworkClass> createManagedInst(
@@ -41,6 +49,7 @@ class Converter {
           std::shared_ptr<FrameworkClass>(std::shared_ptr<FrameworkClass>)>
           post_process = std::function<std::shared_ptr<FrameworkClass>(
               std::shared_ptr<FrameworkClass>)>()) {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
     if (fields.empty()) {
       fields.push_back(Value::Fields(llvm_inst->getType()));
     }
@@ -50,7 +59,7 @@ class Converter {
 
     auto created =
         std::make_shared<FrameworkClass>(llvm_inst, fields, array_element_num);
-    Converter::GetInstance().manageValue(llvm_inst, created);
+    Converter::GetInstance().manageValue(created);
 
     if (!post_process) return created;
     return post_process(created);
@@ -64,13 +73,14 @@ class Converter {
           std::shared_ptr<FrameworkClass>(std::shared_ptr<FrameworkClass>)>
           post_process = std::function<std::shared_ptr<FrameworkClass>(
               std::shared_ptr<FrameworkClass>)>()) {
+    std::lock_guard<std::recursive_mutex> guard(mutex_);
     if (auto managed = Converter::GetInstance().getManagedInst<FrameworkClass>(
             inst->LLVMInstruction(), array_element_num, fields))
       return managed;
 
     auto created =
         std::make_shared<FrameworkClass>(inst, fields, array_element_num);
-    Converter::GetInstance().manageValue(inst->LLVMInstruction(), created);
+    Converter::GetInstance().manageValue(created);
 
     if (!post_process) return created;
     return post_process(created);
@@ -106,10 +116,49 @@ class Converter {
           std::vector<framework::Value::Fields>());
   std::shared_ptr<framework::Value> getManagedValue(ValueSignature signature);
 
+  // Drops the values and caches keyed by the LLVM IR of the previous module,
+  // whose addresses may be reused once it is freed. The IR generator runs
+  // twice on a module (early and as a requirement of the framework passes),
+  // so nothing is dropped while the module stays the same. Like the framework
+  // IR of the IR generator, this expects each module to have its own address.
+  // The interned field lists are kept, as they are keyed by the LLVM types of
+  // the context, which outlives the modules
+  void beginModule(const llvm::Module* module);
+
+  // Number of getManagedValue calls, and of those which found a value
+  size_t Lookups() { return lookups_; }
+  size_t Hits() { return hits_; }
+
  private:
+  // Field lists are interned, so that keys compare them by address
+  struct ValueKey {
+    llvm::Value* value;
+    long array_element_num;
+    const Value::FieldList* fields;
+
+    bool operator==(const ValueKey& key) const {
+      return value == key.value &&
+             array_element_num == key.array_element_num &&
+             fields == key.fields;
+    }
+  };
+
+  struct ValueKeyHash {
+    size_t operator()(const ValueKey& key) const;
+  };
+
   Converter() = default;
 
-  std::map<llvm::Value*, std::vector<std::shared_ptr<framework::Value>>>
+  std::unordered_map<ValueKey, std::shared_ptr<framework::Value>, ValueKeyHash>
       managed_values_;
+
+  // Argument last stored to each alloca (nullptr if none), which would
+  // otherwise be searched in the users of the alloca on every conversion
+  llvm::Value* storedArgument(llvm::AllocaInst* alloca_inst);
+  std::unordered_map<llvm::AllocaInst*, llvm::Value*> stored_arguments_;
+  const llvm::Module* module_ = nullptr;
+  size_t lookups_ = 0;
+  size_t hits_ = 0;
+  std::recursive_mutex mutex_;
 };
 }  // namespace framework
@@ -1,7 +1,13 @@
 #pragma once
+#include <atomic>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "llvm/IR/Constants.h"
@@ -15,6 +21,8 @@ class Value {
   constexpr static int kNonFieldVariable = -1;
   constexpr static int kNonArrayElement = -2;
   constexpr static int kArbitaryArrayElement = -1;
+  constexpr static uint32_t kUnmanagedId =
+      std::numeric_limits<uint32_t>::max();
 
   struct Fields {
     Fields(llvm::Type* type, long field = kNonFieldVariable)
@@ -43,6 +51,16 @@ class Value {
   };
   using FieldList = std::vector<Fields>;
 
+  struct FieldListHash {
+    size_t operator()(const FieldList& fields) const;
+  };
+
+  // Field lists are interned, so that values with the same fields share them
+  // and compare them by address
+  static const FieldList* InternFields(const FieldList& fields);
+  // Returns nullptr when |fields| was never interned
+  static const FieldList* FindFields(const FieldList& fields);
+
   // factory
   static std::shared_ptr<Value> CreateFromDefinition(llvm::Value* value);
   static std::shared_ptr<Value> CreateAppend(std::shared_ptr<Value> src,
@@ -53,22 +71,26 @@ class Value {
   Value(llvm::Value* value, std::vector<Fields> fields, long array_element_num);
   Value(std::shared_ptr<framework::Value> value, std::vector<Fields> fields,
         long array_element_num);
+  // Copies are different values, so they are not managed under the ID of
+  // the copied value
   Value(const Value& value);
+  Value& operator=(const Value& value);
 
   Value(unsigned value_type = 0)
       : value_(nullptr),
+        fields_(InternFields(FieldList())),
         array_element_num_(kNonArrayElement),
-        fields_(std::vector<Fields>()),
+        value_type_(value_type),
         is_global_var_(false),
-        is_return_value_(false),
-        value_type_(value_type){};
+        is_return_value_(false){};
 
   Value(llvm::Value* value)
       : value_(value),
+        fields_(InternFields(FieldList())),
         array_element_num_(kNonArrayElement),
-        fields_(std::vector<Fields>()),
+        value_type_(value->getValueID()),
         is_global_var_(llvm::isa<llvm::GlobalValue>(value)),
-        value_type_(value->getValueID()){};
+        is_return_value_(false){};
 
   Value(std::shared_ptr<Value> value);
 
@@ -98,31 +120,39 @@ class Value {
   // The function name is left as getValueID to be compatible with LLVM,
   // but should be renamed tr o getValueType(), as it is very confusing
   // with the actual ID of this value.
-  const unsigned getValueID() const { return value_type_; };
+  unsigned getValueID() const { return value_type_; };
 
-  const bool isRoot() const { return fields_.empty(); }
+  bool isRoot() const { return fields_->empty(); }
 
-  void addUser(std::shared_ptr<framework::Value> user) {
-    users_.push_back(user);
+  // The ID is published by ManagedValues under its lock, and read without it
+  void setManagedId(uint32_t id) {
+    managed_id_.store(id, std::memory_order_release);
+  }
+  uint32_t ManagedId() const {
+    return managed_id_.load(std::memory_order_acquire);
   }
-
-  std::vector<std::weak_ptr<framework::Value>> Users() { return users_; }
-
-  void setManagedId(size_t id) { managed_id_ = id; }
-  size_t ManagedId() { return managed_id_; }
 
  private:
-  size_t managed_id_;
-
+  // Ordered by size to avoid padding, as every value lives for the whole run
   llvm::Value* value_;
+  const FieldList* fields_;
+  long array_element_num_;
 
   unsigned value_type_;
+  std::atomic<uint32_t> managed_id_{kUnmanagedId};
 
-  long array_element_num_;
   bool is_global_var_;
   bool is_return_value_;
-  std::vector<Fields> fields_;
-  std::vector<std::weak_ptr<framework::Value>> users_;
+};
+
+// Dense ID of a value, for containers indexed by values. Values which are not
+// managed yet are registered when they are stored. Lookups use Find(), which
+// returns kUnmanagedId for them instead, since no container holds them.
+struct ValueID {
+  uint32_t operator()(const std::shared_ptr<Value>& value) const;
+  static uint32_t Find(const std::shared_ptr<Value>& value) {
+    return value->ManagedId();
+  }
 };
 
 class ConstValue : public Value {
@@ -175,6 +205,9 @@ class Argument : public Value {
 class ValueCollection {
  public:
   ValueCollection() = default;
+  ValueCollection(const ValueCollection& collection)
+      : values_(collection.values_) {}
+  ValueCollection& operator=(const ValueCollection& collection);
 
   // factories
   static ValueCollection createFromIntersection(
@@ -199,10 +232,32 @@ class ValueCollection {
   std::set<std::shared_ptr<Value>> getParentValues(
       std::shared_ptr<Value> value) const;
 
-  size_t size() { return values_.size(); }
+  size_t size() const { return values_.size(); }
+
+  // Builds the index of the queries ahead of them, so that a collection
+  // shared with other threads is not modified by its first query
+  void buildIndex() const { getIndex(); }
 
  private:
-  std::set<std::shared_ptr<Value>> values_;
+  using ValueSet = std::set<std::shared_ptr<Value>>;
+
+  /* Values of a single root llvm::Value. A value with fields f_0 ... f_n-1 is
+   * in values_by_depth[n], and in values_by_field[{i, f_i.field}] for each i,
+   * so that both queries only visit the values they return. */
+  struct RootIndex {
+    std::map<size_t, ValueSet> values_by_depth;
+    std::map<std::pair<size_t, long>, ValueSet> values_by_field;
+  };
+  using Index = std::map<const llvm::Value*, RootIndex>;
+
+  // The index is built on the first query or by buildIndex(), and maintained
+  // from then on
+  const Index& getIndex() const;
+  static void addToIndex(Index& index, std::shared_ptr<Value> value);
+  static void removeFromIndex(Index& index, std::shared_ptr<Value> value);
+
+  ValueSet values_;
+  mutable std::unique_ptr<Index> index_;
 };
 
 class AliasValues {
@@ -220,38 +275,46 @@ class AliasValues {
     return updated_values_;
   };
 
-  const std::map<std::shared_ptr<framework::Value>, ValueCollection>&
-  AliasInfo() {
+  // Keyed by the ID of the value
+  const std::unordered_map<uint32_t, ValueCollection>& AliasInfo() {
     return alias_info_;
   };
 
   size_t Size() { return alias_size_; }
 
  private:
-  std::map<std::shared_ptr<framework::Value>, ValueCollection> alias_info_;
+  std::unordered_map<uint32_t, ValueCollection> alias_info_;
 
   std::vector<std::shared_ptr<framework::Value>> updated_values_;
   size_t alias_size_;
 };
 
-// A singleton class which keeps track of managed values
+// A singleton class which keeps track of managed values. Each value is given
+// a dense ID, which stays valid for the rest of the run. The registry holds
+// the values it manages, so they are kept alive until the process exits.
 class ManagedValues {
  public:
-  static ManagedValues GetInstance();
-  constexpr static size_t kReserveSize = 10000;
+  static ManagedValues& GetInstance();
+  // Values are stored in chunks which are never moved, so that they can be
+  // read without taking the lock
+  constexpr static size_t kChunkBits = 16;
+  constexpr static size_t kChunkSize = size_t(1) << kChunkBits;
+  constexpr static size_t kMaxChunks = size_t(1) << (32 - kChunkBits);
 
-  size_t Size() { return managed_values_.size(); }
+  size_t Size() { return size_.load(std::memory_order_acquire); }
 
-  void addValue(std::shared_ptr<framework::Value> value) {
-    value->setManagedId(Size());
-    return managed_values_.push_back(value);
-  }
+  // Returns the ID of |value|, registering it if it has none yet
+  uint32_t addValue(std::shared_ptr<framework::Value> value);
 
   std::shared_ptr<framework::Value> getValueFromID(size_t id);
 
  private:
+  using Chunk = std::unique_ptr<std::shared_ptr<framework::Value>[]>;
+
   ManagedValues();
-  std::vector<std::shared_ptr<framework::Value>> managed_values_;
+  std::mutex mutex_;
+  std::atomic<size_t> size_;
+  std::unique_ptr<Chunk[]> chunks_;
 };
 
 };  // namespace framework
@@ -13,13 +13,28 @@ class IRGenerator : public llvm::FunctionPass {
   IRGenerator();
 
   virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
+  bool doInitialization(llvm::Module &M) override;
   bool runOnFunction(llvm::Function &F) override;
 
   static char ID;
   static std::map<llvm::Module*, std::set<std::shared_ptr<framework::Function>>>
       framework_ir_;
 
+  // Modules for which this returns false are not converted. Set by the
+  // framework passes.
+  static bool (*module_filter_)(llvm::Module &module);
+  // Likewise for the functions of converted modules
+  static bool (*function_filter_)(llvm::Function &function);
+
+  // Functions converted and skipped over all modules
+  static size_t ConvertedFunctions() { return converted_functions_; }
+  static size_t SkippedFunctions() { return skipped_functions_; }
+
  private:
   Analyzer analyzer;
+  bool skip_module_ = false;
+
+  static size_t converted_functions_;
+  static size_t skipped_functions_;
 };  // end of struct
 }  // namespace ir_generator
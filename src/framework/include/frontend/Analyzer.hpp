@@ -31,6 +31,7 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <set>
 #include <stack>
@@ -55,10 +56,31 @@ class Analyzer {
            framework::LoggingClient& client);
 
   void analyze();
+  void flush() { log_.flush(); }
+
+  // Creates an analyzer logging to |client| which shares the function
+  // information of this one, so that functions can be analyzed on several
+  // threads. Must be called before any of the workers starts.
+  std::unique_ptr<Analyzer> createWorker(framework::LoggingClient& client);
+  framework::LoggingClient& LogClient() { return log_; }
+
+  /* Steps driven by the FusedAnalyzer. Each step only touches the state of
+   * this analyzer, so several analyzers can be driven in lockstep. */
+  bool beginFunction(std::shared_ptr<framework::Function> function,
+                     bool reanalyze = false);
+  void endFunction(std::shared_ptr<framework::Function> function);
+  void beginBasicBlock(std::shared_ptr<framework::BasicBlock> block);
+  bool basicBlockChanged(std::shared_ptr<framework::BasicBlock> block);
+  void reportBasicBlock(std::shared_ptr<framework::BasicBlock> block);
+  std::shared_ptr<framework::Function> analyzeInstruction(
+      std::shared_ptr<framework::Instruction> I);
+  void resumeCallInst(std::shared_ptr<framework::Function> called_func,
+                      std::shared_ptr<framework::Instruction> I);
 
   /* Analyzer for each framework instruction */
   void analyzeFunction(std::shared_ptr<framework::Function> F);
-  void analyzeCallInst(std::shared_ptr<framework::Instruction> I);
+  std::shared_ptr<framework::Function> analyzeCallInst(
+      std::shared_ptr<framework::Instruction> I);
   void analyzeStoreInst(std::shared_ptr<framework::Instruction> I);
   void analyzeLoadInst(std::shared_ptr<framework::Instruction> I);
   bool analyzeFunctionCall(std::shared_ptr<framework::CallInst> call_inst);
@@ -66,7 +88,7 @@ class Analyzer {
 
   void analyzePrevBlockBranch(std::shared_ptr<framework::BasicBlock> B);
 
-  void changeValueState(std::vector<Transition> transitions,
+  void changeValueState(const TransitionSet& transitions,
                         std::shared_ptr<framework::Value> value,
                         std::shared_ptr<framework::Instruction> inst);
 
@@ -83,7 +105,7 @@ class Analyzer {
       std::shared_ptr<framework::CallInst> call_inst);
 
   std::shared_ptr<FunctionInformation> currentFunctionInformation() {
-    return function_info_[analyzing_function_.top()];
+    return functionInfo(analyzing_function_.top());
   };
 
   std::shared_ptr<FunctionInformation> getFunctionInformation(
@@ -91,17 +113,43 @@ class Analyzer {
 
   void checkAlias(std::shared_ptr<framework::StoreInst> store_inst);
 
+  // Whether a transition of this state manager may fire in |function| or in a
+  // function it calls, or |function| returns a value used by such a function.
+  // Other functions are not analyzed.
+  bool analyzes(const std::shared_ptr<framework::Function>& function);
+
  private:
+  // Computes analyzed_ with the prescan of the module
+  void computeAnalyzed();
+
   llvm::Module& llvm_module_;
   framework::StateManager& state_manager_;
   framework::LoggingClient& log_;
 
   std::stack<std::shared_ptr<framework::Function>> analyzing_function_;
 
-  std::map<std::shared_ptr<framework::Function>,
-           std::shared_ptr<FunctionInformation>>
-      function_info_;
+  // Entry of |function| in the function information, which is grown to hold
+  // it until workers are created
+  std::shared_ptr<FunctionInformation>& functionInfo(
+      const std::shared_ptr<framework::Function>& function);
+
+  // State shared between an analyzer and its workers. Each function is only
+  // analyzed by one of them, and read by the others once it is analyzed.
+  struct SharedInformation {
+    // Indexed by the function ID. Functions not analyzed yet hold nullptr.
+    std::vector<std::shared_ptr<FunctionInformation>> function_info;
+    // Set once workers share the information. function_info is not resized
+    // from then on.
+    bool has_workers = false;
+    // Stateful constraints are not required to be thread safe
+    std::mutex constraint_mutex;
+  };
+  std::shared_ptr<SharedInformation> shared_;
 
   std::shared_ptr<framework::BasicBlockInformation> bb_info_;
+
+  // Indexed by the function ID. Functions out of range are analyzed.
+  bool analyzed_computed_ = false;
+  std::vector<bool> analyzed_;
 };
 }  // namespace framework
@@ -42,59 +42,83 @@
 #include "core/BasicBlock.hpp"
 #include "core/Function.hpp"
 #include "core/Instructions.hpp"
+#include "core/PersistentMap.hpp"
 
 namespace framework {
 
+/* Logs of a value reaching a state, copied out of the states of a block. The
+ * logs of an argument value are also keyed by the argument and the state the
+ * value had on entry. */
+struct ValueTransitionState {
+  std::shared_ptr<framework::Value> value;
+  TransitionLogs logs;
+  int64_t arg_index = -1;
+  std::optional<State> entry_state{};
+};
+
+/* Logs of an argument value per state it may have on entry. Only the states
+ * a transition started from are stored. */
 class ArgTransitions {
  public:
   ArgTransitions();
-  ArgTransitions(std::set<framework::State> states);
-  ArgTransitions(const ArgTransitions& arg_transitions);
+  ArgTransitions(std::shared_ptr<const std::set<framework::State>> states);
+  ArgTransitions(const ArgTransitions& arg_transitions) = default;
+  ArgTransitions& operator=(const ArgTransitions& arg_transitions) = default;
 
   bool operator==(const ArgTransitions& arg_transitions) const;
+  uint64_t Fingerprint() const;
 
   void addArgTransitions(const ArgTransitions& arg_transitions);
-  bool addTransition(std::vector<Transition>& transitions,
+  bool addTransition(const TransitionSet& transitions,
                      std::shared_ptr<framework::Instruction> inst);
   TransitionLogs getTransitionLog(State state);
-  std::map<framework::State, TransitionLogs>& TransitionPerState() {
+  void setTransitionLog(const State& state, const TransitionLogs& logs);
+  const std::map<framework::State, TransitionLogs>& TransitionPerState() const {
     return transition_per_state_;
   }
 
  private:
+  // Entry states which may start a transition
+  std::shared_ptr<const std::set<framework::State>> states_;
   std::map<framework::State, TransitionLogs> transition_per_state_;
 };
 
 class ArgValueStates {
  public:
+  using ArgTransitionMap =
+      PersistentMap<std::shared_ptr<framework::Value>, ArgTransitions,
+                    framework::ValueID>;
+
   ArgValueStates();
   /* ArgValueStates(uint64_t arg_num); */
-  ArgValueStates(uint64_t arg_num, const std::set<State>& states);
+  ArgValueStates(uint64_t arg_num,
+                 std::shared_ptr<const std::set<State>> states);
   ArgValueStates(const ArgValueStates& arg_value_states);
 
   bool operator==(const ArgValueStates& states);
+  uint64_t Fingerprint() const;
   ArgValueStates& operator=(const ArgValueStates& arg_value_states);
 
-  bool transitionState(std::vector<Transition>& transitions,
+  bool transitionState(const TransitionSet& transitions,
                        std::shared_ptr<framework::Value> value,
                        std::shared_ptr<framework::Instruction> instruction);
 
   void addArgValueState(const ArgValueStates& states);
-  const uint64_t Size() const { return value_states_.size(); }
+  uint64_t Size() const { return value_states_.size(); }
   bool ValueExistsInArg(uint64_t arg, std::shared_ptr<Value>);
 
-  const std::map<std::shared_ptr<framework::Value>, std::vector<Transition>>
-  getValueStateForArg(int64_t index) const;
+  const std::map<std::shared_ptr<framework::Value>, TransitionTable>
+  getValueStateForArg(size_t index) const;
 
   /* const std::map<std::shared_ptr<framework::Value>,
    * std::vector<TransitionLogs>> */
   /* getValueTransitionLogsForArg(int64_t index) const; */
 
-  const std::map<std::shared_ptr<framework::Value>, ArgTransitions>
-  getArgTransitions(int64_t index) const;
+  const ArgTransitionMap getArgTransitions(size_t index) const;
 
-  std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
-  getValueTransitionStates(const framework::State& state);
+  std::vector<ValueTransitionState> getValueTransitionStates(
+      const framework::State& state) const;
+  void setTransitionLog(const ValueTransitionState& state);
 
   void print();
 
@@ -104,58 +128,65 @@ class ArgValueStates {
    * std::vector<TransitionLogs>>> */
   /*     value_states_; */
 
-  std::vector<std::map<std::shared_ptr<framework::Value>, ArgTransitions>>
-      value_states_;
+  std::vector<ArgTransitionMap> value_states_;
 
-  const std::set<State> states_;
+  const std::shared_ptr<const std::set<State>> states_;
 };
 
 class BasicBlockValueStates {
  public:
+  using ValueStateMap =
+      PersistentMap<std::shared_ptr<framework::Value>, TransitionLogs,
+                    framework::ValueID>;
+
   BasicBlockValueStates() = default;
-  BasicBlockValueStates(const BasicBlockValueStates& states);
+  BasicBlockValueStates(const BasicBlockValueStates& states) = default;
+  BasicBlockValueStates& operator=(const BasicBlockValueStates& states) =
+      default;
   bool operator==(const BasicBlockValueStates& states);
+  uint64_t Fingerprint() const { return value_states_.fingerprint(); }
 
   bool valueExists(std::shared_ptr<framework::Value> value);
   void updateReturnValue(std::shared_ptr<framework::BasicBlock> block);
-  bool transitionState(std::vector<Transition>& transitions,
+  bool transitionState(const TransitionSet& transitions,
                        std::shared_ptr<framework::Value> value,
                        std::shared_ptr<framework::Instruction> instruction);
 
   void setValueState(std::shared_ptr<framework::Value> value,
-                     framework::Transition& states,
+                     const framework::Transition& states,
                      std::shared_ptr<framework::Instruction> instruction);
 
   void setValueState(std::shared_ptr<framework::Value> value,
-                     framework::TransitionLogs& logs);
+                     const framework::TransitionLogs& logs);
 
-  TransitionLogs& getTransitionLog(std::shared_ptr<framework::Value> value);
+  const TransitionLogs& getTransitionLog(
+      std::shared_ptr<framework::Value> value) const;
 
   std::vector<std::shared_ptr<framework::Value>> getStateValues(
       const framework::State& state);
 
-  std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
-  getValueTransitionStates(const framework::State& state);
+  std::vector<ValueTransitionState> getValueTransitionStates(
+      const framework::State& state);
 
-  const State& getState(std::shared_ptr<framework::Value> value) {
-    return value_states_[value].CurrentState();
+  const State& getState(std::shared_ptr<framework::Value> value) const {
+    return getTransitionLog(value).CurrentState();
   };
 
-  const std::map<std::shared_ptr<framework::Value>, TransitionLogs>
-  ValueStates() {
-    return value_states_;
-  };
+  const ValueStateMap& ValueStates() const { return value_states_; };
+
+  void removeValue(std::shared_ptr<framework::Value> value) {
+    value_states_.erase(value);
+  }
 
   void print();
 
  private:
-  std::map<std::shared_ptr<framework::Value>, TransitionLogs> value_states_;
+  // Shared with the predecessor until either of them changes a value
+  ValueStateMap value_states_;
 };
 
 class BasicBlockInformation {
  public:
-  constexpr static int kMaxTimeToLive = 5;
-
   enum BlockStatus {
     NONE,
     ERROR,
@@ -164,10 +195,10 @@ class BasicBlockInformation {
   };
 
   BasicBlockInformation(std::shared_ptr<framework::BasicBlock> basic_block,
-                        const std::set<State>& states);
+                        std::shared_ptr<const std::set<State>> states);
   BasicBlockInformation(const BasicBlockInformation& info);
 
-  bool changeValueState(std::vector<Transition>& transitions,
+  bool changeValueState(const TransitionSet& transitions,
                         std::shared_ptr<framework::Value> value,
                         std::shared_ptr<framework::Instruction> instruction);
   bool valueHasState(std::shared_ptr<framework::Value> value);
@@ -190,18 +221,18 @@ class BasicBlockInformation {
   void setPendingValueStates(std::weak_ptr<framework::BasicBlock>,
                              framework::ArgValueStates arg_value_state);
 
-  std::vector<std::pair<std::shared_ptr<framework::Value>, TransitionLogs*>>
-  getValueTransitionStates(const State& state);
+  std::vector<ValueTransitionState> getValueTransitionStates(
+      const State& state);
+  // Writes back the logs of a value returned by getValueTransitionStates
+  void setValueTransitionState(const ValueTransitionState& state);
 
   void setPendingReturnValues(std::weak_ptr<framework::BasicBlock>,
                               std::shared_ptr<framework::ConstValue>);
 
   bool operator==(const framework::BasicBlockInformation& prev_block_info);
 
-  // TODO: TTL should be removed once worklist alogrithm is implemented
-  // correctly
-  void setTimeToLive(int ttl) { time_to_live_ = ttl; }
-  int TimeToLive() { return time_to_live_; }
+  // Hash of the states compared by operator==, for cheap change detection
+  uint64_t Fingerprint() const;
 
   const std::set<std::shared_ptr<framework::Value>>& ReturnValues() {
     return return_values_;
@@ -215,7 +246,9 @@ class BasicBlockInformation {
 
   void removeReturnvalue(int value);
 
-  std::shared_ptr<framework::BasicBlock> BasicBlock() { return basic_block_; };
+  const std::shared_ptr<framework::BasicBlock>& BasicBlock() {
+    return basic_block_;
+  };
 
   void setPartialStates(bool partial_states);
   bool PartialStates() { return is_partial_states_; };
@@ -250,7 +283,7 @@ class BasicBlockInformation {
   std::shared_ptr<framework::BasicBlock> basic_block_;
   struct PendingValues {
     framework::ArgValueStates arg_states;
-    std::set<std::shared_ptr<framework::ConstValue>> return_values;
+    std::set<std::shared_ptr<framework::ConstValue>> return_values{};
   };
 
   struct ValueStates {
@@ -258,8 +291,6 @@ class BasicBlockInformation {
     framework::BasicBlockValueStates value_states_;
   };
 
-  // TODO: remove for quasi worklist algorithm
-  int time_to_live_ = kMaxTimeToLive;
   bool is_partial_states_;
   bool predecessor_partial_;
 
@@ -276,7 +307,7 @@ class BasicBlockInformation {
   framework::ArgValueStates arg_value_states_;
   framework::BasicBlockValueStates value_states_;
 
-  std::set<State> states_;
+  std::shared_ptr<const std::set<State>> states_;
 
   struct ValueStates refcounted_states_;
   BlockStatus status_;
@@ -1,4 +1,5 @@
 #pragma once
+#include <set>
 #include <string>
 #include <vector>
 
@@ -31,6 +32,17 @@ class FrameworkPass : public llvm::ModulePass {
   /*** Main Modular ***/
   bool runOnModule(llvm::Module& M) override;
 
+  // Whether a value may leave the init state somewhere in |module|, judged
+  // from the calls and instructions of its functions
+  bool mayTrigger(llvm::Module& module);
+  // Whether a transition may fire in |function| or in a function it calls,
+  // or |function| returns a value used by such a function
+  bool analyzes(llvm::Function& function);
+  // Prescans over all passes. Modules and functions failing them are neither
+  // converted to the framework IR nor analyzed.
+  static bool AnyMayTrigger(llvm::Module& module);
+  static bool AnyAnalyzes(llvm::Function& function);
+
   virtual void defineStates(){};
   void createTransitions(framework::StateManager& manager);
 
@@ -39,6 +51,19 @@ class FrameworkPass : public llvm::ModulePass {
   }
 
  private:
+  // Defines the states on the first call
+  std::vector<framework::StateManager>& StateManagers();
+
+  // Computes analyzed_functions_ for |module| on the first call
+  const std::set<const llvm::Function*>& AnalyzedFunctions(
+      llvm::Module& module);
+
+  bool states_defined_ = false;
   std::vector<framework::StateManager> manager_;
+
+  // Functions of prescanned_module_ passing analyzes(), empty if the module
+  // does not pass mayTrigger()
+  const llvm::Module* prescanned_module_ = nullptr;
+  std::set<const llvm::Function*> analyzed_functions_;
 };  // end of struct
 }  // namespace framework
@@ -30,6 +30,7 @@
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <optional>
 #include <queue>
 #include <set>
 #include <stack>
@@ -54,6 +55,9 @@ class FunctionInformation {
   static constexpr int kSuccessCode = 0;
 
   static constexpr int kMaxPredCheckDepth = 4;
+  // Number of changes of a block after which its merges are widened to the
+  // reduced transitions, so that growing histories do not keep it changing
+  static constexpr int kWidenAfterChanges = 8;
 
   FunctionInformation(std::shared_ptr<framework::Function> function,
                       AnalysisStat stat = AnalysisStat::UNANALYZED);
@@ -66,25 +70,23 @@ class FunctionInformation {
     return current_basicblock_;
   }
 
-  std::shared_ptr<BasicBlockInformation> getCurrentBasicBlockInformation();
+  const std::shared_ptr<BasicBlockInformation>&
+  getCurrentBasicBlockInformation();
 
-  std::shared_ptr<BasicBlockInformation> getBasicBlockInformation(
-      std::shared_ptr<framework::BasicBlock> basic_block);
-
-  std::shared_ptr<BasicBlockInformation> getBasicBlockPrevInformation(
-      std::shared_ptr<framework::BasicBlock> basic_block);
+  const std::shared_ptr<BasicBlockInformation>& getBasicBlockInformation(
+      const std::shared_ptr<framework::BasicBlock>& basic_block);
 
   std::shared_ptr<BasicBlockInformation> createBasicBlockInfo(
       std::shared_ptr<framework::BasicBlock> basic_block,
-      const std::set<State>& states);
+      std::shared_ptr<const std::set<State>> states,
+      const CustomMergeFunction& custom_merge = CustomMergeFunction());
 
   void addValue(std::shared_ptr<framework::Value> value);
   void addValues(const ValueCollection& value);
   const ValueCollection& GetValueCollection() { return value_collection_; }
 
-  bool basicBlockInfoExists(std::shared_ptr<framework::BasicBlock> basic_block);
-  bool basicBlockPrevInfoExists(
-      std::shared_ptr<framework::BasicBlock> basic_block);
+  bool basicBlockInfoExists(
+      const std::shared_ptr<framework::BasicBlock>& basic_block);
 
   AnalysisStat Stat() { return stat_; }
 
@@ -100,6 +102,10 @@ class FunctionInformation {
     return return_info_;
   };
 
+  // Check if the information visible to the callers (return values and the
+  // argument states on returning blocks) is the same as |info|
+  bool sameSummary(FunctionInformation& info);
+
   std::shared_ptr<framework::Function> Function() {
     return framework_function_;
   }
@@ -115,6 +121,29 @@ class FunctionInformation {
     std::shared_ptr<BasicBlockInformation> current_info;
   };
 
+  // States flowing through an incoming edge, computed from |source|
+  struct EdgeStates {
+    std::weak_ptr<BasicBlockInformation> source;
+    framework::BasicBlockValueStates value_states;
+    framework::ArgValueStates arg_value_states;
+  };
+
+  // Merged incoming states of a block. Only values which changed on some
+  // edge since the last visit are merged again.
+  struct MergedStates {
+    // Keyed by the ID of the source block
+    std::map<long, EdgeStates> edges;
+    framework::BasicBlockValueStates value_states;
+  };
+
+  // Index of |basic_block| in the per block vectors, or -1 when it has no ID
+  long blockIndex(const std::shared_ptr<framework::BasicBlock>& basic_block);
+
+  void mergeValueStates(
+      MergedStates& merged, const std::vector<EdgeStates*>& sources,
+      const std::set<std::shared_ptr<framework::Value>>& changed_values,
+      const CustomMergeFunction& custom_merge, bool widen);
+
   // Found call inst as return value
   std::shared_ptr<framework::Function> framework_function_;
   AnalysisStat stat_;
@@ -123,17 +152,20 @@ class FunctionInformation {
   AliasValues alias_info_;
 
   std::shared_ptr<framework::BasicBlock> current_basicblock_;
+  long current_block_index_ = -1;
   std::shared_ptr<framework::BasicBlock> return_block_;
 
   std::vector<std::shared_ptr<framework::Function>> called_refcount_functions_;
 
-  std::map<std::shared_ptr<framework::BasicBlock>,
-           std::shared_ptr<BasicBlockInformation>>
-      basic_block_info_;
+  // Indexed by the block ID. Blocks without information hold nullptr.
+  std::vector<std::shared_ptr<BasicBlockInformation>> basic_block_info_;
+
+  // Information of each block at the end of its previous visit
+  std::vector<std::shared_ptr<BasicBlockInformation>> prev_basic_block_info_;
+  // Number of visits which changed each block
+  std::vector<int> change_counts_;
 
-  std::map<std::shared_ptr<framework::BasicBlock>,
-           std::shared_ptr<BasicBlockInformation>>
-      prev_basic_block_info_;
+  std::vector<MergedStates> merged_states_;
 
   std::map<int64_t, WeakBasicBlockSet> return_info_;
 };
@@ -0,0 +1,79 @@
+#pragma once
+#include "llvm/IR/Module.h"
+
+// include STL
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "Analyzer.hpp"
+#include "Function.hpp"
+
+namespace framework {
+/* Drives several Analyzers (one for each StateManager) in lockstep. They share
+ * the order in which functions and blocks are visited, and each framework
+ * instruction is handed to every analyzer that is still interested in the
+ * block. The per-block work is not shared: each analyzer keeps its own block
+ * information, and applies the branch facts of the function and looks up
+ * related values, aliases and return values in it on its own.
+ *
+ * Blocks are analyzed with a worklist in reverse post order. A block is queued
+ * again only when the states of one of its predecessors changed. Predecessors
+ * whose own predecessors are not analyzed yet are merged as they are, and the
+ * block is analyzed again once they change. Bugs are reported on each visit,
+ * and the reports of the last visit of each block are kept.
+ *
+ * Functions are analyzed bottom-up over the strongly connected components of
+ * the call graph, so callees are analyzed before their callers. SCCs whose
+ * callees are analyzed run in parallel (see -scc-threads), and their logs are
+ * kept in the bottom-up order. */
+class FusedAnalyzer {
+ public:
+  using Analyzers = std::vector<framework::Analyzer*>;
+  using FunctionSet = std::set<std::shared_ptr<framework::Function>>;
+  using FunctionSCC = std::vector<std::shared_ptr<framework::Function>>;
+
+  /* Maximum number of times mutually recursive functions are analyzed. The
+   * iteration stops as soon as their summary is the same as in the previous
+   * iteration. Reaching the limit means the summary keeps cycling, which is
+   * reported as a warning, and the logs of the last iteration are kept. */
+  constexpr static int kMaxSCCIteration = 16;
+  /* Maximum number of times a block may change before it stops propagating.
+   * Blocks are widened after FunctionInformation::kWidenAfterChanges changes,
+   * so this is only reached by transitions cycling between states. The
+   * baseline analyzed every block at most five times instead. */
+  constexpr static int kMaxBlockVisit = 32;
+
+  FusedAnalyzer(llvm::Module& llvm_module, Analyzers analyzers);
+
+  void analyze();
+  void analyzeSCC(const FunctionSCC& scc);
+  // Analyzes the SCCs whose callees are analyzed on a work stealing pool of
+  // |thread_num| threads, and logs them in the order of |sccs|
+  void analyzeSCCsInParallel(const std::vector<FunctionSCC>& sccs,
+                             const FunctionSet& functions,
+                             unsigned thread_num);
+  void analyzeFunction(std::shared_ptr<framework::Function> function,
+                       const Analyzers& analyzers, bool reanalyze = false);
+  void analyzeBasicBlock(std::shared_ptr<framework::BasicBlock> block,
+                         const Analyzers& analyzers);
+
+  // Callees of each function among |functions|
+  static std::map<std::shared_ptr<framework::Function>, FunctionSCC> CallGraph(
+      const FunctionSet& functions);
+  static std::vector<FunctionSCC> BottomUpSCCs(const FunctionSet& functions);
+
+ private:
+  // Number of values known to the function |analyzer| is analyzing
+  static size_t KnownValues(framework::Analyzer* analyzer);
+
+  llvm::Module& llvm_module_;
+  Analyzers analyzers_;
+
+  // Functions in the SCC under analysis. Calls to these functions use the
+  // result of the previous iteration instead of analyzing them recursively.
+  FunctionSet current_scc_;
+};
+}  // namespace framework
@@ -49,7 +49,7 @@ class StatefulConstraint {
  public:
   StatefulConstraint() = default;
   virtual bool shouldPropagateOnCallInst(
-      std::shared_ptr<framework::CallInst> inst) {
+      std::shared_ptr<framework::CallInst> /* inst */) {
     return true;
   }
 
@@ -26,19 +26,24 @@
 
 // include STL
 #include <algorithm>
+#include <array>
 #include <ctime>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <limits>
 #include <map>
+#include <optional>
 #include <queue>
 #include <set>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "PropagationConstraint.hpp"
 #include "StateTransition.hpp"
+#include "core/Hashing.hpp"
 #include "core/Utils.hpp"
 #include "core/Value.hpp"
 
@@ -57,9 +62,9 @@ struct StateArgs {
       : name_(name),
         type_(type),
         method_(method),
+        timing_(timing),
         early_notification_(early_notification),
-        trigger_constraint_(constraint),
-        timing_(timing){};
+        trigger_constraint_(constraint){};
   std::string name_;
   StateType type_;
   StateMergeMethod method_;
@@ -68,18 +73,28 @@ struct StateArgs {
   TriggerConstraint trigger_constraint_;
 };
 
+/* Handle of a state. The properties of a state are interned and shared by
+ * every copy, so that a State is only an ID, a count and a pointer.
+ *
+ * A counter is a single state carrying a bounded count. Each count compares,
+ * prints and reports as a state of its own ("<name> <count>"), but the
+ * counter has one ID, so it takes one slot in the state set and in the
+ * transition tables whatever its number of counts. */
 class State {
  public:
   constexpr static int kStateMaxNum = 100;
   constexpr static int kBugStateIDBase = INT_MAX - kStateMaxNum;
 
-  State() = default;
+  State();
   State(int ID, std::string name, StateType type = NORMAL,
         StateMergeMethod method = STRICT, bool early_notification = true,
         TriggerConstraint = NONE, BugNotificationTiming timing = IMMEDIATE);
-  State(const State& state);
+  State(const State& state) = default;
 
   State(int ID, StateArgs& args);
+  // Counter of |count_num| counts, whose counts in |bug_counts| are bug states
+  State(int ID, StateArgs& args, int count_num,
+        const std::set<int>& bug_counts);
 
   bool operator<(const State& state) const;
   bool operator<(const StateArgs& args) const;
@@ -87,39 +102,66 @@ class State {
   bool operator!=(const State& state) const;
   bool operator==(const std::string& name) const;
   bool operator==(const StateArgs& args) const;
-  State& operator=(const State& state);
+  State& operator=(const State& state) = default;
 
-  std::string Name() const { return name_; };
-
-  bool isInitState() const { return type_ == StateType::INIT; }
-  bool isBugState() const { return type_ == StateType::BUG; }
-  bool EarlyNotification() const { return early_notification_; }
-
-  TriggerConstraint getTriggerConstraint() const { return trigger_constraint_; }
-  bool isTriggerConstraintSet(TriggerConstraint constraint);
+  const std::string& Name() const {
+    return isCounter() ? properties_->count_names[count_] : properties_->name;
+  };
+  int ID() const { return ID_; }
+  uint64_t Fingerprint() const {
+    return count_ ? HashCombine(ID_, count_) : ID_;
+  }
 
-  const framework::StateMergeMethod MergeMethod() { return method_; };
+  bool isCounter() const { return !properties_->count_names.empty(); }
+  // Number of counts of a counter, 1 for other states
+  int CountNum() const {
+    return isCounter() ? properties_->count_names.size() : 1;
+  }
+  int Count() const { return count_; }
+  // This counter at |count|
+  State WithCount(int count) const;
+
+  bool isInitState() const { return properties_->type == StateType::INIT; }
+  bool isBugState() const {
+    return isCounter() ? properties_->bug_counts[count_]
+                       : properties_->type == StateType::BUG;
+  }
+  bool EarlyNotification() const { return properties_->early_notification; }
 
-  const framework::BugNotificationTiming NotificationTiming() {
-    return timing_;
+  TriggerConstraint getTriggerConstraint() const {
+    return properties_->trigger_constraint;
   }
 
-  void addTransition(State& state, TransitionRule& rule);
+  framework::StateMergeMethod MergeMethod() const {
+    return properties_->method;
+  };
 
-  const std::vector<std::pair<State, TransitionRule>>& Transitions() {
-    return transitions_;
+  framework::BugNotificationTiming NotificationTiming() const {
+    return properties_->timing;
   }
 
  private:
-  int ID_;
-  std::string name_;
-  StateType type_;
-  StateMergeMethod method_;
-  BugNotificationTiming timing_;
-  TriggerConstraint trigger_constraint_;
-  bool early_notification_;
+  struct Properties {
+    std::string name;
+    StateType type;
+    StateMergeMethod method;
+    BugNotificationTiming timing;
+    TriggerConstraint trigger_constraint;
+    bool early_notification;
+    // Counters only, indexed by the count
+    std::vector<std::string> count_names{};
+    std::vector<bool> bug_counts{};
+
+    bool operator==(const Properties& properties) const;
+  };
 
-  std::vector<std::pair<State, TransitionRule>> transitions_;
+  // Returns the shared copy of |properties|, which lives until the end of the
+  // process
+  static const Properties* Intern(const Properties& properties);
+
+  int ID_;
+  int count_ = 0;
+  const Properties* properties_;
 };
 
 class NullState : public State {
@@ -139,6 +181,15 @@ class Transition {
   Transition(const State source, const State target);
   Transition(const Transition& transition);
 
+  // Moves the count of |counter| by |delta|. The count saturates at the last
+  // count, and moving below the first one leads to |underflow|.
+  static Transition Counting(const State& counter, int delta,
+                             const State& underflow);
+  bool isCounting() const { return delta_; }
+  // The transition taken from |source|, a state this transition is registered
+  // for, or nullopt when a counter saturates
+  std::optional<Transition> From(const State& source) const;
+
   void addTransitionRule(std::weak_ptr<TransitionRule> arg);
   const State& Source() const { return source_; };
   const State& Target() const { return target_; };
@@ -156,23 +207,81 @@ class Transition {
   /* State& target_; */
   State source_;
   State target_;
+  // Non zero for counting transitions, whose target is the underflow state
+  int delta_ = 0;
 
   std::vector<std::weak_ptr<TransitionRule>> transition_args_;
 };
 
+/* Transitions of a single trigger, indexed by the ID of the source state. Only
+ * the first transition registered for each source is kept, which is the one a
+ * linear search over the registered transitions would find.
+ *
+ * A transition registered from a counter applies to each of its counts, and
+ * is resolved by find(). Transitions from a single count of a counter, such
+ * as the reduced transitions of callees, take precedence over it. */
+class TransitionTable {
+ public:
+  TransitionTable() = default;
+  TransitionTable(const std::vector<Transition>& transitions);
+
+  void add(const Transition& transition);
+
+  std::optional<Transition> find(const State& source) const;
+  // Transition from the init state with the least target
+  const Transition* InitTransition() const {
+    return init_transition_ ? &*init_transition_ : nullptr;
+  }
+
+  bool empty() const { return !size_; }
+
+ private:
+  constexpr static size_t kNoSlot = std::numeric_limits<size_t>::max();
+
+  // Index of |state| in |by_source_|, or kNoSlot when the ID is not dense
+  static size_t Slot(const State& state);
+
+  std::vector<std::optional<Transition>> by_source_;
+  std::vector<Transition> sparse_sources_;
+  std::optional<Transition> init_transition_;
+  size_t size_ = 0;
+};
+
+/* Tables of the triggers fired by an instruction, in order of precedence.
+ * Holds pointers only, so building one does not allocate. */
+class TransitionSet {
+ public:
+  constexpr static size_t kMaxTables = 4;
+
+  TransitionSet() = default;
+  TransitionSet(const TransitionTable& table) { add(table); }
+
+  void add(const TransitionTable& table);
+
+  std::optional<Transition> find(const State& source) const;
+  const Transition* InitTransition() const;
+
+  bool empty() const { return !size_; }
+
+ private:
+  std::array<const TransitionTable*, kMaxTables> tables_;
+  size_t size_ = 0;
+};
+
 class TransitionLogs {
  public:
   TransitionLogs();
   TransitionLogs(const TransitionLogs& logs);
   TransitionLogs(Transition transition,
                  std::shared_ptr<framework::Instruction> instruction);
+  ~TransitionLogs();
 
   const State& CurrentState() const;
   const std::shared_ptr<framework::Instruction> CurrentInstruction() const {
-    return transition_logs_.back().instruction;
+    return tail_->log.instruction;
   }
 
-  void addTransition(framework::Transition& transition,
+  void addTransition(const framework::Transition& transition,
                      std::shared_ptr<framework::Instruction> instruction);
 
   void setWarned();
@@ -190,8 +299,15 @@ class TransitionLogs {
     return *most_significant_target_;
   };
   Transition ReducedTransition() const;
+  // Logs holding only the reduced transition, for FLEX merges
+  TransitionLogs Collapsed() const;
+
+  bool isDummy() const { return !tail_; };
+  // Number of logged transitions
+  size_t Size() const;
 
-  bool isDummy() const { return transition_logs_.empty(); };
+  // Hash of the logs, updated as transitions are added
+  uint64_t Fingerprint() const { return fingerprint_; }
 
  private:
   struct Log {
@@ -203,15 +319,31 @@ class TransitionLogs {
     }
   };
 
-  std::vector<Log> transition_logs_;
+  /* The logs are a persistent list from the latest transition back to the
+   * first one. Copies share it, and adding a transition allocates one node. */
+  struct Node {
+    Log log;
+    std::shared_ptr<const Node> prev;
+  };
+
+  static void release(std::shared_ptr<const Node>& node);
+
+  std::shared_ptr<const Node> tail_;
+  std::optional<State> first_source_;
   std::optional<State> least_significant_source_;
   std::optional<State> most_significant_target_;
-  bool warned_;
+  bool warned_ = false;
+  uint64_t fingerprint_ = 0;
 };
 
 class StateTransitionManager {
  public:
+  using FunctionArgTransitions =
+      std::pair<const FunctionArgTransitionRule::FunctionArg, TransitionTable>;
+
   StateTransitionManager() = default;
+  // The callee index points into function_transitions_
+  StateTransitionManager(const StateTransitionManager&) = delete;
 
   Transition createTransition(State& source, State& target);
   Transition createTransition(State& source, State& target,
@@ -222,18 +354,52 @@ class StateTransitionManager {
   /* Function Arg Transition Rule*/
   bool existsInFunctionArgTransition(
       const FunctionArgTransitionRule::FunctionArg& arg);
-  const std::pair<FunctionArgTransitionRule::FunctionArg,
-                  std::vector<framework::Transition>>
-  getFunctionArgTransitions(const std::string& name, unsigned int arg);
+  // Returns nullptr when no rule is registered for the argument
+  const FunctionArgTransitions* getFunctionArgTransitions(
+      const std::string& name, unsigned int arg);
+  // Rules of each argument of the callee (nullptr where none is registered),
+  // or nullptr when the callee has no rules
+  const std::vector<const FunctionArgTransitions*>* getCalleeTransitions(
+      const std::string& name);
 
   /* Store Inst Transition Rule*/
-  std::vector<framework::Transition> getStoreArgTransitions(
+  const TransitionTable& getStoreArgTransitions(
       framework::StoreValueTransitionRule::StoreValueType type,
       const std::string& name = std::string());
 
-  std::vector<framework::Transition> getUseValueTransitions();
+  const TransitionTable& getUseValueTransitions() { return use_transitions_; }
+
+  const TransitionTable& getAliasTransitions() { return alias_transitions_; }
+
+  /* Module prescan */
+  // Callees whose calls fire a transition
+  std::set<std::string> CalleeNames() const;
 
-  std::vector<framework::Transition> getAliasTransitions();
+  // Instructions on which a transition may fire without calling one of them
+  struct InstructionTriggers {
+    bool load = false;
+    // Any store, including memset
+    bool store = false;
+    bool null_store = false;
+    // Comparisons with null
+    bool null_branch = false;
+
+    InstructionTriggers& operator|=(const InstructionTriggers& triggers);
+  };
+  // With |init_only|, only the transitions leaving the init state count
+  InstructionTriggers UncalledTriggers(bool init_only) const;
+
+  // Whether |function| has an instruction on which one of |triggers|, or a
+  // call to one of |callee_names|, may fire a transition
+  static bool HasLocalTrigger(const llvm::Function& function,
+                              const std::set<std::string>& callee_names,
+                              const InstructionTriggers& triggers);
+  // Functions of |module| to analyze: those with a local trigger and their
+  // callers, and the defined functions whose result one of them uses, as the
+  // return values decide which paths of the caller are taken
+  static std::set<const llvm::Function*> AnalyzedFunctions(
+      const llvm::Module& module, const std::set<std::string>& callee_names,
+      const InstructionTriggers& triggers);
 
  private:
   /* Register Function Arg Transition Rule*/
@@ -253,20 +419,21 @@ class StateTransitionManager {
   void registerAliasTransition(std::shared_ptr<AliasValueTransitionRule> rule,
                                framework::Transition transition);
 
-  std::map<FunctionArgTransitionRule::FunctionArg,
-           std::vector<framework::Transition>>
+  std::map<FunctionArgTransitionRule::FunctionArg, TransitionTable>
       function_transitions_;
+  // Hashed by the callee name, so that a call is looked up once
+  std::unordered_map<std::string, std::vector<const FunctionArgTransitions*>>
+      callee_transitions_;
 
   /* Register Store Inst */
-  std::map<std::string, std::vector<framework::Transition>>
-      call_store_transitions_;
+  std::map<std::string, TransitionTable> call_store_transitions_;
 
   std::map<framework::StoreValueTransitionRule::StoreValueType,
-           std::vector<framework::Transition>>
+           TransitionTable>
       store_transitions_;
 
-  std::vector<framework::Transition> use_transitions_;
-  std::vector<framework::Transition> alias_transitions_;
+  TransitionTable use_transitions_;
+  TransitionTable alias_transitions_;
 
   std::set<Transition> transitions_;
 
@@ -275,6 +442,11 @@ class StateTransitionManager {
       rules_;
 };
 
+/* Merge of the logs of a value reaching a join point through several edges,
+ * used when the least of their states has the CUSTOM merge method. */
+using CustomMergeFunction = std::function<TransitionLogs(
+    const std::vector<const TransitionLogs*>& candidates)>;
+
 class StateManager {
  public:
   StateManager();
@@ -286,6 +458,15 @@ class StateManager {
   State& createState(StateArgs& args);
   std::set<State> createStates(std::vector<StateArgs>& states);
 
+  /* Bounded counter of the |inc| and |dec| transitions from |base|, with the
+   * counts 0..|size|-1 named "<name> <count>" after |args|. |inc| moves from
+   * |base| to count 0 and then up a count, saturating at the last count. |dec|
+   * moves down a count, and from count 0 back to |base|. The counts in
+   * |bug_counts| are bug states. */
+  State& createCounterState(State& base, StateArgs& args, int size,
+                            TransitionRule& inc, TransitionRule& dec,
+                            const std::set<int>& bug_counts = {});
+
   void addTransition(State& source, State& target, TransitionRule& rule);
 
   State& getByName(const std::string& name);
@@ -298,6 +479,10 @@ class StateManager {
 
   State& getInitState();
   const std::set<State>& getStates();
+  // Immutable snapshot of the states, shared by the block information
+  std::shared_ptr<const std::set<State>> SharedStates() {
+    return shared_states_;
+  }
   const std::set<State> getBugStates();
 
   std::shared_ptr<framework::StateTransitionManager> TransitionManager();
@@ -308,11 +493,16 @@ class StateManager {
     return propagation_constraint_;
   }
 
+  void setCustomMerge(CustomMergeFunction merge) { custom_merge_ = merge; }
+  const CustomMergeFunction& getCustomMerge() const { return custom_merge_; }
+
  private:
   std::set<State> states_;
+  std::shared_ptr<const std::set<State>> shared_states_;
   std::set<State> bug_states_;
   std::shared_ptr<framework::StateTransitionManager> transition_manager_;
   std::shared_ptr<framework::StatefulConstraint> propagation_constraint_;
+  CustomMergeFunction custom_merge_;
 
   State* init_state_;
 
@@ -0,0 +1,52 @@
+#pragma once
+// include STL
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace framework {
+/* A pool of threads which each run the tasks of their own queue, newest
+ * first, and steal the oldest task of another queue once theirs is empty.
+ * Tasks are given the index of the worker running them, so that they can use
+ * state kept per worker, and may push further tasks. */
+class WorkStealingPool {
+ public:
+  using Task = std::function<void(size_t worker)>;
+
+  explicit WorkStealingPool(size_t worker_num);
+
+  size_t WorkerNum() const { return queues_.size(); }
+
+  // Queues |task| on the queue of |worker|
+  void push(size_t worker, Task task);
+
+  // Runs the queued tasks, and the tasks they push, until none are left.
+  // Returns once every worker thread joined.
+  void run();
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void work(size_t worker);
+  bool pop(size_t worker, Task& task);
+  bool steal(size_t worker, Task& task);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+
+  // Tasks pushed but not finished yet, and tasks waiting in a queue
+  std::atomic<size_t> pending_;
+  std::atomic<size_t> queued_;
+
+  // Idle workers wait here until a task is queued or every task is done
+  std::mutex idle_mutex_;
+  std::condition_variable idle_;
+};
+}  // namespace framework
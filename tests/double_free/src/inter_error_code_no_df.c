@@ -0,0 +1,20 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NAME 100
+
+// Frees |name| and returns 0, or returns -1 without freeing it
+int release(char *name, int busy) {
+  if (busy)
+    return -1;
+  free(name);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  char *name = (char *) malloc(NAME);
+
+  if (release(name, argc) < 0)
+    free(name); // Only reached when release() did not free `name`
+  return 0;
+}
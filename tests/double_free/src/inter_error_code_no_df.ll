@@ -0,0 +1,84 @@
+source_filename = "/tmp/tests/double_free/src/inter_error_code_no_df.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+define dso_local i32 @release(i8* %name, i32 %busy) !dbg !100 {
+entry:
+  %retval = alloca i32, align 4
+  %name.addr = alloca i8*, align 8
+  %busy.addr = alloca i32, align 4
+  store i8* %name, i8** %name.addr, align 8
+  store i32 %busy, i32* %busy.addr, align 4
+  %0 = load i32, i32* %busy.addr, align 4, !dbg !101
+  %tobool = icmp ne i32 %0, 0, !dbg !102
+  br i1 %tobool, label %if.then, label %if.end, !dbg !103
+if.then:
+  store i32 -1, i32* %retval, align 4, !dbg !104
+  br label %return, !dbg !105
+if.end:
+  %1 = load i8*, i8** %name.addr, align 8, !dbg !106
+  call void @free(i8* %1), !dbg !107
+  store i32 0, i32* %retval, align 4, !dbg !108
+  br label %return, !dbg !109
+return:
+  %2 = load i32, i32* %retval, align 4, !dbg !110
+  ret i32 %2, !dbg !111
+}
+define dso_local i32 @main(i32 %argc, i8** %argv) !dbg !112 {
+entry:
+  %retval = alloca i32, align 4
+  %argc.addr = alloca i32, align 4
+  %argv.addr = alloca i8**, align 8
+  %name = alloca i8*, align 8
+  store i32 0, i32* %retval, align 4
+  store i32 %argc, i32* %argc.addr, align 4
+  store i8** %argv, i8*** %argv.addr, align 8
+  %call = call noalias i8* @malloc(i64 100), !dbg !113
+  store i8* %call, i8** %name, align 8, !dbg !114
+  %0 = load i8*, i8** %name, align 8, !dbg !115
+  %1 = load i32, i32* %argc.addr, align 4, !dbg !116
+  %call1 = call i32 @release(i8* %0, i32 %1), !dbg !117
+  %cmp = icmp slt i32 %call1, 0, !dbg !118
+  br i1 %cmp, label %if.then, label %if.end, !dbg !119
+if.then:
+  %2 = load i8*, i8** %name, align 8, !dbg !120
+  call void @free(i8* %2), !dbg !121
+  br label %if.end, !dbg !122
+if.end:
+  ret i32 0, !dbg !123
+}
+declare dso_local noalias i8* @malloc(i64)
+declare dso_local void @free(i8*)
+
+declare void @llvm.dbg.declare(metadata, metadata, metadata)
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3, !4}
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, enums: !2, splitDebugInlining: false, nameTableKind: None)
+!1 = !DIFile(filename: "/tmp/tests/double_free/src/inter_error_code_no_df.c", directory: "/tmp/tests/double_free/src")
+!2 = !{}
+!3 = !{i32 7, !"Dwarf Version", i32 4}
+!4 = !{i32 2, !"Debug Info Version", i32 3}
+!5 = !DISubroutineType(types: !2)
+!100 = distinct !DISubprogram(name: "release", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!101 = !DILocation(line: 8, column: 7, scope: !100)
+!102 = !DILocation(line: 8, column: 7, scope: !100)
+!103 = !DILocation(line: 8, column: 7, scope: !100)
+!104 = !DILocation(line: 9, column: 5, scope: !100)
+!105 = !DILocation(line: 9, column: 5, scope: !100)
+!106 = !DILocation(line: 10, column: 8, scope: !100)
+!107 = !DILocation(line: 10, column: 3, scope: !100)
+!108 = !DILocation(line: 11, column: 3, scope: !100)
+!109 = !DILocation(line: 11, column: 3, scope: !100)
+!110 = !DILocation(line: 12, column: 1, scope: !100)
+!111 = !DILocation(line: 12, column: 1, scope: !100)
+!112 = distinct !DISubprogram(name: "main", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!113 = !DILocation(line: 15, column: 25, scope: !112)
+!114 = !DILocation(line: 15, column: 9, scope: !112)
+!115 = !DILocation(line: 17, column: 15, scope: !112)
+!116 = !DILocation(line: 17, column: 21, scope: !112)
+!117 = !DILocation(line: 17, column: 7, scope: !112)
+!118 = !DILocation(line: 17, column: 27, scope: !112)
+!119 = !DILocation(line: 17, column: 7, scope: !112)
+!120 = !DILocation(line: 18, column: 10, scope: !112)
+!121 = !DILocation(line: 18, column: 5, scope: !112)
+!122 = !DILocation(line: 18, column: 5, scope: !112)
+!123 = !DILocation(line: 19, column: 3, scope: !112)
@@ -0,0 +1,16 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NAME 100
+
+void free_char(char *name) {
+  free(name);
+}
+
+int main() {
+  char *name = (char *) malloc(NAME);
+
+  free(name);
+  free_char(name); // BUG: double free of `name` inside free_char()
+  return 0;
+}
@@ -0,0 +1,48 @@
+source_filename = "/tmp/tests/double_free/src/inter_freed_arg_df.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+define dso_local void @free_char(i8* %name) !dbg !100 {
+entry:
+  %name.addr = alloca i8*, align 8
+  store i8* %name, i8** %name.addr, align 8
+  %0 = load i8*, i8** %name.addr, align 8, !dbg !101
+  call void @free(i8* %0), !dbg !102
+  ret void, !dbg !103
+}
+define dso_local i32 @main() !dbg !104 {
+entry:
+  %retval = alloca i32, align 4
+  %name = alloca i8*, align 8
+  store i32 0, i32* %retval, align 4
+  %call = call noalias i8* @malloc(i64 100), !dbg !105
+  store i8* %call, i8** %name, align 8, !dbg !106
+  %0 = load i8*, i8** %name, align 8, !dbg !107
+  call void @free(i8* %0), !dbg !108
+  %1 = load i8*, i8** %name, align 8, !dbg !109
+  call void @free_char(i8* %1), !dbg !110
+  ret i32 0, !dbg !111
+}
+declare dso_local noalias i8* @malloc(i64)
+declare dso_local void @free(i8*)
+
+declare void @llvm.dbg.declare(metadata, metadata, metadata)
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3, !4}
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, enums: !2, splitDebugInlining: false, nameTableKind: None)
+!1 = !DIFile(filename: "/tmp/tests/double_free/src/inter_freed_arg_df.c", directory: "/tmp/tests/double_free/src")
+!2 = !{}
+!3 = !{i32 7, !"Dwarf Version", i32 4}
+!4 = !{i32 2, !"Debug Info Version", i32 3}
+!5 = !DISubroutineType(types: !2)
+!100 = distinct !DISubprogram(name: "free_char", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!101 = !DILocation(line: 7, column: 8, scope: !100)
+!102 = !DILocation(line: 7, column: 3, scope: !100)
+!103 = !DILocation(line: 8, column: 1, scope: !100)
+!104 = distinct !DISubprogram(name: "main", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!105 = !DILocation(line: 11, column: 25, scope: !104)
+!106 = !DILocation(line: 11, column: 9, scope: !104)
+!107 = !DILocation(line: 13, column: 8, scope: !104)
+!108 = !DILocation(line: 13, column: 3, scope: !104)
+!109 = !DILocation(line: 14, column: 13, scope: !104)
+!110 = !DILocation(line: 14, column: 3, scope: !104)
+!111 = !DILocation(line: 15, column: 3, scope: !104)
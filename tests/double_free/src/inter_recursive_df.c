@@ -0,0 +1,27 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NAME 100
+
+void release_next(char *name, int n);
+
+// Frees |name| once the recursion through release_next() ends
+void release(char *name, int n) {
+  if (n > 0) {
+    release_next(name, n - 1);
+    return;
+  }
+  free(name);
+}
+
+void release_next(char *name, int n) {
+  release(name, n);
+}
+
+int main() {
+  char *name = (char *) malloc(NAME);
+
+  release(name, 3);
+  free(name); // BUG: double free of `name` here
+  return 0;
+}
@@ -0,0 +1,87 @@
+source_filename = "/tmp/tests/double_free/src/inter_recursive_df.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+define dso_local void @release(i8* %name, i32 %n) !dbg !100 {
+entry:
+  %name.addr = alloca i8*, align 8
+  %n.addr = alloca i32, align 4
+  store i8* %name, i8** %name.addr, align 8
+  store i32 %n, i32* %n.addr, align 4
+  %0 = load i32, i32* %n.addr, align 4, !dbg !101
+  %cmp = icmp sgt i32 %0, 0, !dbg !102
+  br i1 %cmp, label %if.then, label %if.end, !dbg !103
+if.then:
+  %1 = load i8*, i8** %name.addr, align 8, !dbg !104
+  %2 = load i32, i32* %n.addr, align 4, !dbg !105
+  %sub = sub nsw i32 %2, 1, !dbg !106
+  call void @release_next(i8* %1, i32 %sub), !dbg !107
+  br label %return, !dbg !108
+if.end:
+  %3 = load i8*, i8** %name.addr, align 8, !dbg !109
+  call void @free(i8* %3), !dbg !110
+  br label %return, !dbg !111
+return:
+  ret void, !dbg !112
+}
+define dso_local void @release_next(i8* %name, i32 %n) !dbg !113 {
+entry:
+  %name.addr = alloca i8*, align 8
+  %n.addr = alloca i32, align 4
+  store i8* %name, i8** %name.addr, align 8
+  store i32 %n, i32* %n.addr, align 4
+  %0 = load i8*, i8** %name.addr, align 8, !dbg !114
+  %1 = load i32, i32* %n.addr, align 4, !dbg !115
+  call void @release(i8* %0, i32 %1), !dbg !116
+  ret void, !dbg !117
+}
+define dso_local i32 @main() !dbg !118 {
+entry:
+  %retval = alloca i32, align 4
+  %name = alloca i8*, align 8
+  store i32 0, i32* %retval, align 4
+  %call = call noalias i8* @malloc(i64 100), !dbg !119
+  store i8* %call, i8** %name, align 8, !dbg !120
+  %0 = load i8*, i8** %name, align 8, !dbg !121
+  call void @release(i8* %0, i32 3), !dbg !122
+  %1 = load i8*, i8** %name, align 8, !dbg !123
+  call void @free(i8* %1), !dbg !124
+  ret i32 0, !dbg !125
+}
+declare dso_local noalias i8* @malloc(i64)
+declare dso_local void @free(i8*)
+
+declare void @llvm.dbg.declare(metadata, metadata, metadata)
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3, !4}
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, enums: !2, splitDebugInlining: false, nameTableKind: None)
+!1 = !DIFile(filename: "/tmp/tests/double_free/src/inter_recursive_df.c", directory: "/tmp/tests/double_free/src")
+!2 = !{}
+!3 = !{i32 7, !"Dwarf Version", i32 4}
+!4 = !{i32 2, !"Debug Info Version", i32 3}
+!5 = !DISubroutineType(types: !2)
+!100 = distinct !DISubprogram(name: "release", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!101 = !DILocation(line: 10, column: 7, scope: !100)
+!102 = !DILocation(line: 10, column: 9, scope: !100)
+!103 = !DILocation(line: 10, column: 7, scope: !100)
+!104 = !DILocation(line: 11, column: 18, scope: !100)
+!105 = !DILocation(line: 11, column: 24, scope: !100)
+!106 = !DILocation(line: 11, column: 26, scope: !100)
+!107 = !DILocation(line: 11, column: 5, scope: !100)
+!108 = !DILocation(line: 12, column: 5, scope: !100)
+!109 = !DILocation(line: 14, column: 8, scope: !100)
+!110 = !DILocation(line: 14, column: 3, scope: !100)
+!111 = !DILocation(line: 15, column: 1, scope: !100)
+!112 = !DILocation(line: 15, column: 1, scope: !100)
+!113 = distinct !DISubprogram(name: "release_next", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!114 = !DILocation(line: 18, column: 11, scope: !113)
+!115 = !DILocation(line: 18, column: 17, scope: !113)
+!116 = !DILocation(line: 18, column: 3, scope: !113)
+!117 = !DILocation(line: 19, column: 1, scope: !113)
+!118 = distinct !DISubprogram(name: "main", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!119 = !DILocation(line: 22, column: 25, scope: !118)
+!120 = !DILocation(line: 22, column: 9, scope: !118)
+!121 = !DILocation(line: 24, column: 11, scope: !118)
+!122 = !DILocation(line: 24, column: 3, scope: !118)
+!123 = !DILocation(line: 25, column: 8, scope: !118)
+!124 = !DILocation(line: 25, column: 3, scope: !118)
+!125 = !DILocation(line: 26, column: 3, scope: !118)
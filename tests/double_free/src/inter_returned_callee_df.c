@@ -0,0 +1,21 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NAME 100
+
+int get_status(void) {
+  return 0;
+}
+
+int release(char *name) {
+  free(name);
+  return get_status(); // get_status() cannot free, but decides the return value
+}
+
+int main() {
+  char *name = (char *) malloc(NAME);
+
+  release(name);
+  free(name); // BUG: double free of `name`, freed inside release()
+  return 0;
+}
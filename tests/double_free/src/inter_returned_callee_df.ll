@@ -0,0 +1,56 @@
+source_filename = "/tmp/tests/double_free/src/inter_returned_callee_df.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+define dso_local i32 @get_status() !dbg !100 {
+entry:
+  ret i32 0, !dbg !101
+}
+define dso_local i32 @release(i8* %name) !dbg !102 {
+entry:
+  %name.addr = alloca i8*, align 8
+  store i8* %name, i8** %name.addr, align 8
+  %0 = load i8*, i8** %name.addr, align 8, !dbg !103
+  call void @free(i8* %0), !dbg !104
+  %call = call i32 @get_status(), !dbg !105
+  ret i32 %call, !dbg !106
+}
+define dso_local i32 @main() !dbg !107 {
+entry:
+  %retval = alloca i32, align 4
+  %name = alloca i8*, align 8
+  store i32 0, i32* %retval, align 4
+  %call = call noalias i8* @malloc(i64 100), !dbg !108
+  store i8* %call, i8** %name, align 8, !dbg !109
+  %0 = load i8*, i8** %name, align 8, !dbg !110
+  %call1 = call i32 @release(i8* %0), !dbg !111
+  %1 = load i8*, i8** %name, align 8, !dbg !112
+  call void @free(i8* %1), !dbg !113
+  ret i32 0, !dbg !114
+}
+declare dso_local noalias i8* @malloc(i64)
+declare dso_local void @free(i8*)
+
+declare void @llvm.dbg.declare(metadata, metadata, metadata)
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3, !4}
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, enums: !2, splitDebugInlining: false, nameTableKind: None)
+!1 = !DIFile(filename: "/tmp/tests/double_free/src/inter_returned_callee_df.c", directory: "/tmp/tests/double_free/src")
+!2 = !{}
+!3 = !{i32 7, !"Dwarf Version", i32 4}
+!4 = !{i32 2, !"Debug Info Version", i32 3}
+!5 = !DISubroutineType(types: !2)
+!100 = distinct !DISubprogram(name: "get_status", scope: !1, file: !1, line: 6, type: !5, scopeLine: 6, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!101 = !DILocation(line: 7, column: 3, scope: !100)
+!102 = distinct !DISubprogram(name: "release", scope: !1, file: !1, line: 10, type: !5, scopeLine: 10, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!103 = !DILocation(line: 11, column: 8, scope: !102)
+!104 = !DILocation(line: 11, column: 3, scope: !102)
+!105 = !DILocation(line: 12, column: 10, scope: !102)
+!106 = !DILocation(line: 12, column: 3, scope: !102)
+!107 = distinct !DISubprogram(name: "main", scope: !1, file: !1, line: 15, type: !5, scopeLine: 15, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!108 = !DILocation(line: 16, column: 25, scope: !107)
+!109 = !DILocation(line: 16, column: 9, scope: !107)
+!110 = !DILocation(line: 18, column: 11, scope: !107)
+!111 = !DILocation(line: 18, column: 3, scope: !107)
+!112 = !DILocation(line: 19, column: 8, scope: !107)
+!113 = !DILocation(line: 19, column: 3, scope: !107)
+!114 = !DILocation(line: 20, column: 3, scope: !107)
@@ -0,0 +1,13 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NAME 100
+
+int main(int argc, char **argv) {
+  char *name = (char *) malloc(NAME); // BUG: leaked when the loop never runs
+
+  for (int i = 0; i < argc; i++) {
+    free(name);
+  }
+  return 0;
+}
@@ -0,0 +1,63 @@
+source_filename = "/tmp/tests/memory_leak/src/intra_loop_leak.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+define dso_local i32 @main(i32 %argc, i8** %argv) !dbg !100 {
+entry:
+  %retval = alloca i32, align 4
+  %argc.addr = alloca i32, align 4
+  %argv.addr = alloca i8**, align 8
+  %name = alloca i8*, align 8
+  %i = alloca i32, align 4
+  store i32 0, i32* %retval, align 4
+  store i32 %argc, i32* %argc.addr, align 4
+  store i8** %argv, i8*** %argv.addr, align 8
+  %call = call noalias i8* @malloc(i64 100), !dbg !101
+  store i8* %call, i8** %name, align 8, !dbg !102
+  store i32 0, i32* %i, align 4, !dbg !103
+  br label %for.cond, !dbg !104
+for.cond:
+  %0 = load i32, i32* %i, align 4, !dbg !105
+  %1 = load i32, i32* %argc.addr, align 4, !dbg !106
+  %cmp = icmp slt i32 %0, %1, !dbg !107
+  br i1 %cmp, label %for.body, label %for.end, !dbg !108
+for.body:
+  %2 = load i8*, i8** %name, align 8, !dbg !109
+  call void @free(i8* %2), !dbg !110
+  br label %for.inc, !dbg !111
+for.inc:
+  %3 = load i32, i32* %i, align 4, !dbg !112
+  %inc = add nsw i32 %3, 1, !dbg !113
+  store i32 %inc, i32* %i, align 4, !dbg !114
+  br label %for.cond, !dbg !115
+for.end:
+  ret i32 0, !dbg !116
+}
+declare dso_local noalias i8* @malloc(i64)
+declare dso_local void @free(i8*)
+
+declare void @llvm.dbg.declare(metadata, metadata, metadata)
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3, !4}
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, enums: !2, splitDebugInlining: false, nameTableKind: None)
+!1 = !DIFile(filename: "/tmp/tests/memory_leak/src/intra_loop_leak.c", directory: "/tmp/tests/memory_leak/src")
+!2 = !{}
+!3 = !{i32 7, !"Dwarf Version", i32 4}
+!4 = !{i32 2, !"Debug Info Version", i32 3}
+!5 = !DISubroutineType(types: !2)
+!100 = distinct !DISubprogram(name: "main", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!101 = !DILocation(line: 7, column: 25, scope: !100)
+!102 = !DILocation(line: 7, column: 9, scope: !100)
+!103 = !DILocation(line: 9, column: 12, scope: !100)
+!104 = !DILocation(line: 9, column: 8, scope: !100)
+!105 = !DILocation(line: 9, column: 19, scope: !100)
+!106 = !DILocation(line: 9, column: 23, scope: !100)
+!107 = !DILocation(line: 9, column: 21, scope: !100)
+!108 = !DILocation(line: 9, column: 3, scope: !100)
+!109 = !DILocation(line: 10, column: 10, scope: !100)
+!110 = !DILocation(line: 10, column: 5, scope: !100)
+!111 = !DILocation(line: 11, column: 3, scope: !100)
+!112 = !DILocation(line: 9, column: 30, scope: !100)
+!113 = !DILocation(line: 9, column: 30, scope: !100)
+!114 = !DILocation(line: 9, column: 30, scope: !100)
+!115 = !DILocation(line: 9, column: 3, scope: !100)
+!116 = !DILocation(line: 12, column: 3, scope: !100)
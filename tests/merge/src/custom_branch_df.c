@@ -0,0 +1,21 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NAME 100
+
+int main(int argc, char **argv) {
+  char *name = (char *) malloc(NAME);
+
+  if (argc > 1) {
+    free(name);
+    name = (char *) malloc(NAME);
+    free(name);
+  } else {
+    free(name);
+  }
+
+  // The paths join with `name` freed on both, and the CUSTOM merge keeps the
+  // shorter history through line 14
+  free(name); // BUG: double free of `name` here
+  return 0;
+}
@@ -0,0 +1,64 @@
+source_filename = "/tmp/tests/merge/src/custom_branch_df.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+define dso_local i32 @main(i32 %argc, i8** %argv) !dbg !100 {
+entry:
+  %retval = alloca i32, align 4
+  %argc.addr = alloca i32, align 4
+  %argv.addr = alloca i8**, align 8
+  %name = alloca i8*, align 8
+  store i32 0, i32* %retval, align 4
+  store i32 %argc, i32* %argc.addr, align 4
+  store i8** %argv, i8*** %argv.addr, align 8
+  %call = call noalias i8* @malloc(i64 100), !dbg !101
+  store i8* %call, i8** %name, align 8, !dbg !102
+  %0 = load i32, i32* %argc.addr, align 4, !dbg !103
+  %cmp = icmp sgt i32 %0, 1, !dbg !104
+  br i1 %cmp, label %if.then, label %if.else, !dbg !105
+if.then:
+  %1 = load i8*, i8** %name, align 8, !dbg !106
+  call void @free(i8* %1), !dbg !107
+  %call1 = call noalias i8* @malloc(i64 100), !dbg !108
+  store i8* %call1, i8** %name, align 8, !dbg !109
+  %2 = load i8*, i8** %name, align 8, !dbg !110
+  call void @free(i8* %2), !dbg !111
+  br label %if.end, !dbg !112
+if.else:
+  %3 = load i8*, i8** %name, align 8, !dbg !113
+  call void @free(i8* %3), !dbg !114
+  br label %if.end
+if.end:
+  %4 = load i8*, i8** %name, align 8, !dbg !115
+  call void @free(i8* %4), !dbg !116
+  ret i32 0, !dbg !117
+}
+declare dso_local noalias i8* @malloc(i64)
+declare dso_local void @free(i8*)
+
+declare void @llvm.dbg.declare(metadata, metadata, metadata)
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3, !4}
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, enums: !2, splitDebugInlining: false, nameTableKind: None)
+!1 = !DIFile(filename: "/tmp/tests/merge/src/custom_branch_df.c", directory: "/tmp/tests/merge/src")
+!2 = !{}
+!3 = !{i32 7, !"Dwarf Version", i32 4}
+!4 = !{i32 2, !"Debug Info Version", i32 3}
+!5 = !DISubroutineType(types: !2)
+!100 = distinct !DISubprogram(name: "main", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!101 = !DILocation(line: 7, column: 25, scope: !100)
+!102 = !DILocation(line: 7, column: 9, scope: !100)
+!103 = !DILocation(line: 9, column: 7, scope: !100)
+!104 = !DILocation(line: 9, column: 12, scope: !100)
+!105 = !DILocation(line: 9, column: 7, scope: !100)
+!106 = !DILocation(line: 10, column: 10, scope: !100)
+!107 = !DILocation(line: 10, column: 5, scope: !100)
+!108 = !DILocation(line: 11, column: 21, scope: !100)
+!109 = !DILocation(line: 11, column: 10, scope: !100)
+!110 = !DILocation(line: 12, column: 10, scope: !100)
+!111 = !DILocation(line: 12, column: 5, scope: !100)
+!112 = !DILocation(line: 13, column: 3, scope: !100)
+!113 = !DILocation(line: 14, column: 10, scope: !100)
+!114 = !DILocation(line: 14, column: 5, scope: !100)
+!115 = !DILocation(line: 19, column: 8, scope: !100)
+!116 = !DILocation(line: 19, column: 3, scope: !100)
+!117 = !DILocation(line: 20, column: 3, scope: !100)
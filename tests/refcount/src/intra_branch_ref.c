@@ -0,0 +1,29 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+struct kref {
+  int refcount;
+};
+
+void kref_get(struct kref* kref) {}
+int kref_put(struct kref* kref, void (*release)(struct kref* kref)) {
+  return 0;
+}
+void release(struct kref* kref) {}
+
+int main(int argc, char** argv) {
+  struct kref ref;
+
+  if (argc > 1) {
+    kref_get(&ref);
+    kref_get(&ref);
+    kref_put(&ref, release);
+  } else {
+    kref_get(&ref);
+  }
+
+  // Both paths hold one reference here, and the transitions of the first one
+  // are logged
+  kref_get(&ref); // BUG: two references are never put
+  return 0;
+}
@@ -0,0 +1,75 @@
+source_filename = "/tmp/tests/refcount/src/intra_branch_ref.c"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+%struct.kref = type { i32 }
+define dso_local void @kref_get(%struct.kref* %kref) !dbg !100 {
+entry:
+  %kref.addr = alloca %struct.kref*, align 8
+  store %struct.kref* %kref, %struct.kref** %kref.addr, align 8
+  ret void, !dbg !101
+}
+define dso_local i32 @kref_put(%struct.kref* %kref, void (%struct.kref*)* %release) !dbg !102 {
+entry:
+  %kref.addr = alloca %struct.kref*, align 8
+  %release.addr = alloca void (%struct.kref*)*, align 8
+  store %struct.kref* %kref, %struct.kref** %kref.addr, align 8
+  store void (%struct.kref*)* %release, void (%struct.kref*)** %release.addr, align 8
+  ret i32 0, !dbg !103
+}
+define dso_local void @release(%struct.kref* %kref) !dbg !104 {
+entry:
+  %kref.addr = alloca %struct.kref*, align 8
+  store %struct.kref* %kref, %struct.kref** %kref.addr, align 8
+  ret void, !dbg !105
+}
+define dso_local i32 @main(i32 %argc, i8** %argv) !dbg !106 {
+entry:
+  %retval = alloca i32, align 4
+  %argc.addr = alloca i32, align 4
+  %argv.addr = alloca i8**, align 8
+  %ref = alloca %struct.kref, align 4
+  store i32 0, i32* %retval, align 4
+  store i32 %argc, i32* %argc.addr, align 4
+  store i8** %argv, i8*** %argv.addr, align 8
+  %0 = load i32, i32* %argc.addr, align 4, !dbg !107
+  %cmp = icmp sgt i32 %0, 1, !dbg !108
+  br i1 %cmp, label %if.then, label %if.else, !dbg !109
+if.then:
+  call void @kref_get(%struct.kref* %ref), !dbg !110
+  call void @kref_get(%struct.kref* %ref), !dbg !111
+  %c = call i32 @kref_put(%struct.kref* %ref, void (%struct.kref*)* @release), !dbg !112
+  br label %if.end, !dbg !113
+if.else:
+  call void @kref_get(%struct.kref* %ref), !dbg !114
+  br label %if.end
+if.end:
+  call void @kref_get(%struct.kref* %ref), !dbg !115
+  ret i32 0, !dbg !116
+}
+
+declare void @llvm.dbg.declare(metadata, metadata, metadata)
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3, !4}
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "clang", isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, enums: !2, splitDebugInlining: false, nameTableKind: None)
+!1 = !DIFile(filename: "/tmp/tests/refcount/src/intra_branch_ref.c", directory: "/tmp/tests/refcount/src")
+!2 = !{}
+!3 = !{i32 7, !"Dwarf Version", i32 4}
+!4 = !{i32 2, !"Debug Info Version", i32 3}
+!5 = !DISubroutineType(types: !2)
+!100 = distinct !DISubprogram(name: "kref_get", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!101 = !DILocation(line: 8, column: 34, scope: !100)
+!102 = distinct !DISubprogram(name: "kref_put", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!103 = !DILocation(line: 10, column: 3, scope: !102)
+!104 = distinct !DISubprogram(name: "release", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!105 = !DILocation(line: 12, column: 34, scope: !104)
+!106 = distinct !DISubprogram(name: "main", scope: !1, file: !1, line: 1, type: !5, scopeLine: 1, spFlags: DISPFlagDefinition, unit: !0, retainedNodes: !2)
+!107 = !DILocation(line: 17, column: 7, scope: !106)
+!108 = !DILocation(line: 17, column: 12, scope: !106)
+!109 = !DILocation(line: 17, column: 7, scope: !106)
+!110 = !DILocation(line: 18, column: 5, scope: !106)
+!111 = !DILocation(line: 19, column: 5, scope: !106)
+!112 = !DILocation(line: 20, column: 5, scope: !106)
+!113 = !DILocation(line: 21, column: 3, scope: !106)
+!114 = !DILocation(line: 22, column: 5, scope: !106)
+!115 = !DILocation(line: 27, column: 3, scope: !106)
+!116 = !DILocation(line: 28, column: 3, scope: !106)
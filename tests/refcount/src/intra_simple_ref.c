@@ -0,0 +1,26 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+struct kref {
+  int refcount;
+};
+
+void kref_get(struct kref* kref) {}
+int kref_put(struct kref* kref, void (*release)(struct kref* kref)) {
+  return 0;
+}
+void release(struct kref* kref) {}
+
+int main() {
+  struct kref balanced;
+  struct kref leaked;
+
+  kref_get(&balanced);
+  kref_get(&balanced);
+  kref_put(&balanced, release);
+  kref_put(&balanced, release);
+
+  kref_get(&leaked);
+  kref_get(&leaked); // BUG: two references of `leaked` are never put
+  return 0;
+}